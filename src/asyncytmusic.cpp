@@ -11,9 +11,13 @@
 #include <QFutureInterface>
 #include <QCoreApplication>
 #include <QTimer>
+#include <QStringBuilder>
+#include <QtConcurrent>
 
 #include <KLocalizedString>
 
+#include "responsecache.h"
+
 #include <pybind11/embed.h>
 
 #include <iostream>
@@ -26,6 +30,7 @@ namespace py = pybind11;
 #include <ranges>
 #include <type_traits>
 #include <memory>
+#include <utility>
 
 template <typename T, typename OP>
 std::optional<std::invoke_result_t<OP, T>> mapOptional(const std::optional<T> &optional, OP op) {
@@ -40,9 +45,16 @@ std::optional<std::invoke_result_t<OP, T>> mapOptional(const std::optional<T> &o
     return std::nullopt;
 }
 
-AsyncYTMusic::AsyncYTMusic(QObject *parent)
+constexpr int DEFAULT_WORKER_COUNT = 3;
+
+AsyncYTMusic::AsyncYTMusic(int workerCount, QObject *parent)
     : QObject(parent)
 {
+    m_workers.setObjectName(QStringLiteral("YTMusicAPI"));
+    m_workers.setMaxThreadCount(workerCount);
+    // Keep idle workers around, so they don't have to set up ytmusicapi and yt-dlp again
+    m_workers.setExpiryTimeout(-1);
+
     qRegisterMetaType<std::vector<artist::Artist::Album>>();
     qRegisterMetaType<std::vector<search::SearchResultItem>>();
     qRegisterMetaType<artist::Artist>();
@@ -69,13 +81,71 @@ AsyncYTMusic::AsyncYTMusic(QObject *parent)
     });
 }
 
+/// Returns the response stored in the ResponseCache for the key, or fetches and stores it
+template <typename Func>
+std::invoke_result_t<Func> cached(const QString &key, Func fetch) {
+    using ReturnType = std::invoke_result_t<Func>;
+
+    const auto &cache = ResponseCache::instance();
+    if (auto value = cache.lookup<ReturnType>(key)) {
+        return *value;
+    }
+
+    ReturnType value = fetch();
+    cache.store(key, value);
+    return value;
+}
+
+AsyncYTMusic::~AsyncYTMusic()
+{
+    // Running requests may still emit errorOccurred, so wait for them while this object is intact
+    m_workers.clear();
+    m_workers.waitForDone();
+}
+
+void AsyncYTMusic::cancelCaller(const QString &key, const std::shared_ptr<PendingCallBase> &call)
+{
+    std::scoped_lock lock(m_inFlightMutex);
+    if (--call->activeCallers > 0 || call->canceled || call->finished) {
+        return;
+    }
+
+    // Nobody is interested in the result anymore. New callers need to start a new request.
+    call->canceled = true;
+    if (m_inFlight.value(key) == call) {
+        m_inFlight.remove(key);
+    }
+
+    if (call->runningOn) {
+        // Interrupting needs the GIL, which may take a moment to get, so don't block the caller's thread.
+        // Only the interrupt mutex of the request is held while waiting for it, which makes sure the worker doesn't move on
+        // to another request in the meantime, without blocking other requests on the in-flight mutex.
+        QtConcurrent::run([this, call] {
+            std::scoped_lock interruptLock(call->interruptMutex);
+
+            YTMusic *runningOn = nullptr;
+            {
+                std::scoped_lock lock(m_inFlightMutex);
+                runningOn = call->runningOn;
+            }
+
+            if (runningOn) {
+                runningOn->interrupt();
+            }
+        });
+    }
+}
+
 //
 // search
 //
 QFuture<std::vector<search::SearchResultItem>> AsyncYTMusic::search(const QString &query)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->search(query.toStdString());
+    const QString key = QStringLiteral("search:") % query;
+    return invokeAndCatchOnThread(key, [=](YTMusic &ytm) {
+        return cached(key, [&] {
+            return ytm.search(query.toStdString());
+        });
     });
 }
 
@@ -84,8 +154,11 @@ QFuture<std::vector<search::SearchResultItem>> AsyncYTMusic::search(const QStrin
 //
 QFuture<artist::Artist> AsyncYTMusic::fetchArtist(const QString &channelId)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->get_artist(channelId.toStdString());
+    const QString key = QStringLiteral("fetchArtist:") % channelId;
+    return invokeAndCatchOnThread(key, [=](YTMusic &ytm) {
+        return cached(key, [&] {
+            return ytm.get_artist(channelId.toStdString());
+        });
     });
 }
 
@@ -94,8 +167,11 @@ QFuture<artist::Artist> AsyncYTMusic::fetchArtist(const QString &channelId)
 //
 QFuture<album::Album> AsyncYTMusic::fetchAlbum(const QString &browseId)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->get_album(browseId.toStdString());
+    const QString key = QStringLiteral("fetchAlbum:") % browseId;
+    return invokeAndCatchOnThread(key, [=](YTMusic &ytm) {
+        return cached(key, [&] {
+            return ytm.get_album(browseId.toStdString());
+        });
     });
 }
 
@@ -104,12 +180,12 @@ QFuture<album::Album> AsyncYTMusic::fetchAlbum(const QString &browseId)
 //
 QFuture<std::optional<song::Song>> AsyncYTMusic::fetchSong(const QString &videoId)
 {
-    return invokeAndCatchOnThread([=, this]() -> std::optional<song::Song> {
+    return invokeAndCatchOnThread(QStringLiteral("fetchSong:") % videoId, [=](YTMusic &ytm) -> std::optional<song::Song> {
         if (videoId.isEmpty()) {
             return {};
         }
 
-        return m_ytm->get_song(videoId.toStdString());
+        return ytm.get_song(videoId.toStdString());
     });
 }
 
@@ -117,8 +193,36 @@ QFuture<std::optional<song::Song>> AsyncYTMusic::fetchSong(const QString &videoI
 // fetchPlaylist
 //
 QFuture<playlist::Playlist> AsyncYTMusic::fetchPlaylist(const QString &playlistId) {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->get_playlist(playlistId.toStdString());
+    const QString key = QStringLiteral("fetchPlaylist:") % playlistId;
+    return invokeAndCatchOnThread(key, [=](YTMusic &ytm) {
+        return cached(key, [&] {
+            return ytm.get_playlist(playlistId.toStdString());
+        });
+    });
+}
+
+QFuture<playlist::Playlist> AsyncYTMusic::fetchPlaylistPages(const QString &playlistId)
+{
+    // Shares the cache entry with fetchPlaylist, which contains the complete playlist
+    const QString key = QStringLiteral("fetchPlaylist:") % playlistId;
+    return invokeAndReportOnThread<playlist::Playlist>(QStringLiteral("fetchPlaylistPages:") % playlistId, [=](YTMusic &ytm, const auto &report) {
+        const auto &cache = ResponseCache::instance();
+        if (auto playlist = cache.lookup<playlist::Playlist>(key)) {
+            report(*playlist);
+            return;
+        }
+
+        playlist::Playlist complete {};
+        bool first = true;
+        ytm.get_playlist_pages(playlistId.toStdString(), [&](playlist::Playlist &&page) {
+            if (std::exchange(first, false)) {
+                complete = page;
+            } else {
+                complete.tracks.insert(complete.tracks.end(), page.tracks.begin(), page.tracks.end());
+            }
+            report(page);
+        });
+        cache.store(key, complete);
     });
 }
 
@@ -127,8 +231,8 @@ QFuture<playlist::Playlist> AsyncYTMusic::fetchPlaylist(const QString &playlistI
 //
 QFuture<std::vector<artist::Artist::Album>> AsyncYTMusic::fetchArtistAlbums(const QString &channelId, const QString &params)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->get_artist_albums(channelId.toStdString(), params.toStdString());
+    return invokeAndCatchOnThread(QStringLiteral("fetchArtistAlbums:") % channelId % u':' % params, [=](YTMusic &ytm) {
+        return ytm.get_artist_albums(channelId.toStdString(), params.toStdString());
     });
 }
 
@@ -137,8 +241,19 @@ QFuture<std::vector<artist::Artist::Album>> AsyncYTMusic::fetchArtistAlbums(cons
 //
 QFuture<video_info::VideoInfo> AsyncYTMusic::extractVideoInfo(const QString &videoId)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->extract_video_info(videoId.toStdString());
+    // Replaying a track doesn't need another yt-dlp run, as long as its stream URL is still valid
+    if (auto info = m_streams.lookup(videoId)) {
+        QFutureInterface<video_info::VideoInfo> interface;
+        interface.reportStarted();
+        interface.reportResult(*info);
+        interface.reportFinished();
+        return interface.future();
+    }
+
+    return invokeAndCatchOnThread(QStringLiteral("extractVideoInfo:") % videoId, [=, this](YTMusic &ytm) {
+        auto info = ytm.extract_video_info(videoId.toStdString());
+        m_streams.store(videoId, info);
+        return info;
     });
 }
 
@@ -147,8 +262,8 @@ QFuture<video_info::VideoInfo> AsyncYTMusic::extractVideoInfo(const QString &vid
 //
 QFuture<watch::Playlist> AsyncYTMusic::fetchWatchPlaylist(const std::optional<QString> &videoId, const std::optional<QString> &playlistId)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->get_watch_playlist(
+    return invokeAndCatchOnThread(QStringLiteral("fetchWatchPlaylist:") % videoId.value_or(QString()) % u':' % playlistId.value_or(QString()), [=](YTMusic &ytm) {
+        return ytm.get_watch_playlist(
             mapOptional(videoId, &QString::toStdString),
             mapOptional(playlistId,  &QString::toStdString)
         );
@@ -157,20 +272,30 @@ QFuture<watch::Playlist> AsyncYTMusic::fetchWatchPlaylist(const std::optional<QS
 
 QFuture<Lyrics> AsyncYTMusic::fetchLyrics(const QString &browseId)
 {
-    return invokeAndCatchOnThread([=, this]() {
-        return m_ytm->get_lyrics(
-            browseId.toStdString()
-        );
+    const QString key = QStringLiteral("fetchLyrics:") % browseId;
+    return invokeAndCatchOnThread(key, [=](YTMusic &ytm) {
+        return cached(key, [&] {
+            return ytm.get_lyrics(
+                browseId.toStdString()
+            );
+        });
     });
 }
 
 QFuture<QString> AsyncYTMusic::version()
 {
-    return invokeAndCatchOnThread([this]() {
-        return QString::fromStdString(m_ytm->get_version());
+    return invokeAndCatchOnThread(QStringLiteral("version"), [](YTMusic &ytm) {
+        return QString::fromStdString(ytm.get_version());
     });
 }
 
+YTMusic &AsyncYTMusic::threadYTMusic()
+{
+    // Python interpreter will be initialized from the first thread calling the methods
+    thread_local Lazy<YTMusic> ytm;
+    return *ytm.get();
+}
+
 YTMusicThread &YTMusicThread::instance()
 {
     static YTMusicThread thread;
@@ -179,8 +304,7 @@ YTMusicThread &YTMusicThread::instance()
 
 YTMusicThread::~YTMusicThread()
 {
-    quit();
-    wait();
+    delete m_ytm;
 }
 
 AsyncYTMusic *YTMusicThread::operator->()
@@ -194,10 +318,14 @@ AsyncYTMusic &YTMusicThread::get()
 }
 
 YTMusicThread::YTMusicThread()
-    : m_ytm(new AsyncYTMusic())
+    : m_ytm(new AsyncYTMusic([] {
+        bool ok = false;
+        const int count = qEnvironmentVariableIntValue("AUDIOTUBE_YTMUSIC_WORKERS", &ok);
+        return ok && count > 0 ? count : DEFAULT_WORKER_COUNT;
+    }()))
 {
-    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, m_ytm, &QObject::deleteLater);
-    setObjectName(QStringLiteral("YTMusicAPI"));
-    m_ytm->moveToThread(this);
-    start();
+    // Don't start requests that were still queued when the application is closed
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, m_ytm, [this] {
+        m_ytm->m_workers.clear();
+    });
 }
@@ -5,18 +5,22 @@
 #pragma once
 
 #include <QObject>
-#include <QThread>
+#include <QThreadPool>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QHash>
 
 #include <QCoroTask>
 #include <QCoroFuture>
 
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 #include <ytmusic.h>
 
+#include "streamurlcache.h"
+
 constexpr QStringView YTMUSIC_WEB_BASE_URL = u"https://music.youtube.com/";
 
 Q_DECLARE_METATYPE(std::vector<artist::Artist::Album>);
@@ -53,6 +57,27 @@ private:
     std::unique_ptr<T> m_item = nullptr;
 };
 
+///
+/// State of a request, shared by all callers that requested the same thing.
+/// Protected by the in-flight mutex of AsyncYTMusic.
+///
+struct PendingCallBase {
+    int activeCallers = 0;
+    bool canceled = false;
+    bool finished = false;
+    /// The object running the request, if it was already picked up by a worker
+    YTMusic *runningOn = nullptr;
+    /// Held while the request is interrupted, so its worker can't move on to the next request meanwhile.
+    /// Needs to be locked before the in-flight mutex.
+    std::mutex interruptMutex;
+};
+
+template <typename T>
+struct PendingCall : PendingCallBase {
+    std::vector<QFutureInterface<T>> callers;
+    std::vector<T> results;
+};
+
 class AsyncYTMusic : public QObject
 {
     friend class YTMusicThread;
@@ -71,6 +96,11 @@ public:
 
     QFuture<playlist::Playlist> fetchPlaylist(const QString &playlistId);
 
+    /// Reports the playlist as multiple results, as soon as each page of it is available.
+    /// The first result contains the playlist metadata and the first tracks,
+    /// all following results only contain tracks that need to be appended.
+    QFuture<playlist::Playlist> fetchPlaylistPages(const QString &playlistId);
+
     QFuture<std::vector<artist::Artist::Album>> fetchArtistAlbums(const QString &channelId, const QString &params);
 
     QFuture<video_info::VideoInfo> extractVideoInfo(const QString &videoId);
@@ -85,36 +115,155 @@ public:
     Q_SIGNAL void errorOccurred(const QString &error);
 
 protected:
-    explicit AsyncYTMusic(QObject *parent = nullptr);
+    explicit AsyncYTMusic(int workerCount, QObject *parent = nullptr);
+    ~AsyncYTMusic() override;
 
 private:
-    /// Invokes the given function on the thread of the YTMusic object, and handles exceptions that occur while invoking it.
+    /// Invokes the given function on the next idle worker thread, and handles exceptions that occur while invoking it.
+    /// The function is passed the YTMusic object of the worker it runs on.
+    ///
+    /// If a request with the same key is already in flight, its future is returned instead of starting another one.
+    /// The key needs to identify both the method and its arguments.
     template <typename Func>
-    QFuture<std::invoke_result_t<Func>> invokeAndCatchOnThread(Func fun) {
-        using ReturnType = std::invoke_result_t<Func>;
-        auto interface = std::make_shared<QFutureInterface<ReturnType>>();
-        QMetaObject::invokeMethod(this, [=, this]() {
+    QFuture<std::invoke_result_t<Func, YTMusic &>> invokeAndCatchOnThread(const QString &key, Func fun) {
+        using ReturnType = std::invoke_result_t<Func, YTMusic &>;
+        return invokeAndReportOnThread<ReturnType>(key, [fun](YTMusic &ytm, const auto &report) {
+            report(fun(ytm));
+        });
+    }
+
+    /// Like invokeAndCatchOnThread, but the function can report any number of results
+    /// by calling the report function it is passed as second argument.
+    /// If the function fails before reporting anything, a default constructed result is reported.
+    ///
+    /// Every caller gets its own future, which it can cancel without affecting the other callers.
+    /// Once all of them are canceled, the request is dropped if it is still queued, or interrupted if it is running.
+    template <typename T, typename Func>
+    QFuture<T> invokeAndReportOnThread(const QString &key, Func fun) {
+        QFutureInterface<T> caller;
+        caller.reportStarted();
+
+        std::shared_ptr<PendingCall<T>> call;
+        {
+            std::scoped_lock lock(m_inFlightMutex);
+            if (auto it = m_inFlight.constFind(key); it != m_inFlight.cend()) {
+                call = std::static_pointer_cast<PendingCall<T>>(*it);
+                // Catch up with the results reported before this caller joined
+                for (const auto &result : call->results) {
+                    caller.reportResult(result, caller.resultCount());
+                }
+            } else {
+                call = std::make_shared<PendingCall<T>>();
+                m_inFlight.insert(key, call);
+                m_workers.start([=, this]() {
+                    runPendingCall(key, call, fun);
+                });
+            }
+
+            call->callers.push_back(caller);
+            call->activeCallers++;
+        }
+
+        // The watcher is a child of this object, so watchers of futures that never finish don't leak.
+        // Children have to be created on the thread of their parent.
+        QMetaObject::invokeMethod(this, [=, this, future = caller.future()] {
+            auto *watcher = new QFutureWatcher<T>(this);
+            connect(watcher, &QFutureWatcher<T>::canceled, this, [=, this] {
+                cancelCaller(key, call);
+            });
+            connect(watcher, &QFutureWatcher<T>::finished, watcher, &QObject::deleteLater);
+            watcher->setFuture(future);
+        });
+
+        return caller.future();
+    }
+
+    template <typename T, typename Func>
+    void runPendingCall(const QString &key, const std::shared_ptr<PendingCall<T>> &call, const Func &fun) {
+        auto &ytm = threadYTMusic();
+
+        bool canceled = false;
+        {
+            std::scoped_lock lock(m_inFlightMutex);
+            // Requests that were canceled while they were queued are dropped
+            canceled = call->canceled;
+            call->runningOn = &ytm;
+        }
+
+        const auto report = [&](const T &val) {
+            std::scoped_lock lock(m_inFlightMutex);
+            call->results.push_back(val);
+            for (auto &caller : call->callers) {
+                if (!caller.isCanceled()) {
+                    caller.reportResult(val, caller.resultCount());
+                }
+            }
+        };
+
+        if (!canceled) {
             try {
-                ReturnType val = fun();
-                interface->reportResult(val);
-                interface->reportFinished();
+                fun(ytm, report);
             } catch (const std::exception &err) {
-                interface->reportResult({});
-                interface->reportFinished();
-                Q_EMIT errorOccurred(QString::fromLocal8Bit(err.what()));
+                {
+                    std::scoped_lock lock(m_inFlightMutex);
+                    canceled = call->canceled;
+                }
+
+                // Interrupted requests are expected to fail, nobody is waiting for them anymore
+                if (!canceled) {
+                    if (call->results.empty()) {
+                        report({});
+                    }
+                    Q_EMIT errorOccurred(QString::fromLocal8Bit(err.what()));
+                }
             }
-        });
-        return interface->future();
+        }
+
+        // Remove the request before finishing it, so later callers don't get a finished future.
+        // Waits for an interruption that is still in progress, so it doesn't hit the next request of this worker.
+        std::unique_lock interruptLock(call->interruptMutex);
+        {
+            std::scoped_lock lock(m_inFlightMutex);
+            canceled = call->canceled;
+        }
+        // An interruption that arrived between two Python calls, or after the last one, is still pending.
+        // Takes the GIL, so the in-flight mutex can't be held meanwhile, as reporting results takes it while holding the GIL.
+        if (canceled) {
+            ytm.reset_interruption();
+        }
+        std::scoped_lock lock(m_inFlightMutex);
+        call->runningOn = nullptr;
+        call->finished = true;
+        if (m_inFlight.value(key) == call) {
+            m_inFlight.remove(key);
+        }
+        for (auto &caller : call->callers) {
+            caller.reportFinished();
+        }
     }
 
-    // Python interpreter will be initialized from the thread calling the methods
-    Lazy<YTMusic> m_ytm;
+    /// Called when one of the callers of a request cancels its future
+    void cancelCaller(const QString &key, const std::shared_ptr<PendingCallBase> &call);
+
+    /// Each worker thread owns a YTMusic object, so requests running in parallel don't share any Python state
+    /// except for the interpreter. It is initialized lazily on the first request the worker handles.
+    static YTMusic &threadYTMusic();
+
+    QThreadPool m_workers;
+    StreamUrlCache m_streams;
+
+    std::mutex m_inFlightMutex;
+    QHash<QString, std::shared_ptr<PendingCallBase>> m_inFlight;
 };
 
-class YTMusicThread : private QThread {
+///
+/// Owns the AsyncYTMusic instance and its pool of worker threads.
+/// The number of workers can be set using the AUDIOTUBE_YTMUSIC_WORKERS environment variable.
+///
+class YTMusicThread {
 public:
     static YTMusicThread &instance();
-    ~YTMusicThread() override;
+    ~YTMusicThread();
 
     AsyncYTMusic *operator->();
     AsyncYTMusic &get();
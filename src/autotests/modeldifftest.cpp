@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "modeldiff.h"
+
+#include <QAbstractItemModelTester>
+#include <QAbstractListModel>
+#include <QSignalSpy>
+#include <QTest>
+
+namespace {
+
+struct Row {
+    int key = 0;
+    QString value;
+
+    bool operator==(const Row &other) const = default;
+};
+
+class TestModel : public KeyedListModel<QAbstractListModel>
+{
+public:
+    using KeyedListModel::KeyedListModel;
+
+    int rowCount(const QModelIndex &parent = {}) const override
+    {
+        return parent.isValid() ? 0 : int(m_rows.size());
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (role != Qt::DisplayRole) {
+            return {};
+        }
+        const auto &row = m_rows.at(index.row());
+        return QStringLiteral("%1:%2").arg(row.key).arg(row.value);
+    }
+
+    void setRows(std::vector<Row> &&rows)
+    {
+        updateRows(m_rows, std::move(rows), &Row::key);
+    }
+
+    QStringList contents() const
+    {
+        QStringList contents;
+        for (int i = 0; i < rowCount(); i++) {
+            contents.append(data(index(i), Qt::DisplayRole).toString());
+        }
+        return contents;
+    }
+
+private:
+    std::vector<Row> m_rows;
+};
+
+class VariantModel : public KeyedListModel<QAbstractListModel>
+{
+public:
+    using Variant = std::variant<int, QString>;
+
+    int rowCount(const QModelIndex &parent = {}) const override
+    {
+        return parent.isValid() ? 0 : int(m_rows.size());
+    }
+
+    QVariant data(const QModelIndex &, int) const override
+    {
+        return {};
+    }
+
+    void setRows(std::vector<Variant> &&rows)
+    {
+        updateRows(m_rows, std::move(rows), [](const Variant &row) {
+            return row.index();
+        });
+    }
+
+private:
+    std::vector<Variant> m_rows;
+};
+
+///
+/// Applies the signals of the model to a copy of its contents, the way a view would.
+/// If the signals are correct, the copy matches the model afterwards.
+///
+class Mirror : public QObject
+{
+public:
+    explicit Mirror(TestModel *model)
+        : m_model(model)
+        , m_contents(model->contents())
+    {
+        connect(model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+            for (int i = first; i <= last; i++) {
+                m_contents.insert(i, m_model->data(m_model->index(i), Qt::DisplayRole).toString());
+            }
+        });
+        connect(model, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &, int first, int last) {
+            m_contents.remove(first, last - first + 1);
+        });
+        connect(model, &QAbstractItemModel::rowsMoved, this,
+                [this](const QModelIndex &, int start, int end, const QModelIndex &, int destination) {
+                    const int count = end - start + 1;
+                    const QStringList moved = m_contents.mid(start, count);
+                    m_contents.remove(start, count);
+                    const int insertAt = destination > end ? destination - count : destination;
+                    for (int i = 0; i < count; i++) {
+                        m_contents.insert(insertAt + i, moved.at(i));
+                    }
+                });
+        connect(model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+            for (int i = topLeft.row(); i <= bottomRight.row(); i++) {
+                m_contents[i] = m_model->data(m_model->index(i), Qt::DisplayRole).toString();
+            }
+        });
+        connect(model, &QAbstractItemModel::modelReset, this, [this] {
+            m_contents = m_model->contents();
+        });
+    }
+
+    QStringList contents() const
+    {
+        return m_contents;
+    }
+
+private:
+    TestModel *m_model;
+    QStringList m_contents;
+};
+
+/// Parses rows written as "1:a 2:b"
+std::vector<Row> parseRows(const QString &text)
+{
+    std::vector<Row> rows;
+    const auto items = text.split(u' ', Qt::SkipEmptyParts);
+    for (const auto &item : items) {
+        const auto parts = item.split(u':');
+        rows.push_back(Row { parts.at(0).toInt(), parts.value(1, QStringLiteral("a")) });
+    }
+    return rows;
+}
+
+}
+
+class ModelDiffTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void updateRows_data()
+    {
+        QTest::addColumn<QString>("oldRows");
+        QTest::addColumn<QString>("newRows");
+        QTest::addColumn<int>("insertions");
+        QTest::addColumn<int>("removals");
+        QTest::addColumn<int>("moves");
+        QTest::addColumn<int>("changes");
+        QTest::addColumn<int>("resets");
+
+        QTest::newRow("unchanged") << u"1 2 3"_qs << u"1 2 3"_qs << 0 << 0 << 0 << 0 << 0;
+        QTest::newRow("from empty") << QString() << u"1 2"_qs << 1 << 0 << 0 << 0 << 0;
+        QTest::newRow("clear") << u"1 2"_qs << QString() << 0 << 1 << 0 << 0 << 0;
+        QTest::newRow("insert at front") << u"1 2"_qs << u"0 1 2"_qs << 1 << 0 << 0 << 0 << 0;
+        QTest::newRow("insert in middle and at end") << u"1 3"_qs << u"1 2 3 4"_qs << 2 << 0 << 0 << 0 << 0;
+        QTest::newRow("insert run") << u"1 4"_qs << u"1 2 3 4"_qs << 1 << 0 << 0 << 0 << 0;
+        QTest::newRow("remove run") << u"1 2 3 4 5"_qs << u"1 5"_qs << 0 << 1 << 0 << 0 << 0;
+        QTest::newRow("remove separate rows") << u"1 2 3 4"_qs << u"2 4"_qs << 0 << 2 << 0 << 0 << 0;
+        QTest::newRow("move to front") << u"1 2 3"_qs << u"3 1 2"_qs << 0 << 0 << 1 << 0 << 0;
+        QTest::newRow("reverse") << u"1 2 3"_qs << u"3 2 1"_qs << 0 << 0 << 2 << 0 << 0;
+        QTest::newRow("change run") << u"1:a 2:a 3:a"_qs << u"1:a 2:b 3:b"_qs << 0 << 0 << 0 << 1 << 0;
+        QTest::newRow("change separate rows") << u"1:a 2:a 3:a"_qs << u"1:b 2:a 3:b"_qs << 0 << 0 << 0 << 2 << 0;
+        QTest::newRow("mixed") << u"1:a 2:a 3:a 4:a"_qs << u"4:a 5:a 2:b 1:a"_qs << 1 << 1 << 2 << 1 << 0;
+        QTest::newRow("duplicate keys") << u"1 2"_qs << u"1 1"_qs << 0 << 0 << 0 << 0 << 1;
+    }
+
+    void updateRows()
+    {
+        QFETCH(QString, oldRows);
+        QFETCH(QString, newRows);
+        QFETCH(int, insertions);
+        QFETCH(int, removals);
+        QFETCH(int, moves);
+        QFETCH(int, changes);
+        QFETCH(int, resets);
+
+        TestModel model;
+        model.setRows(parseRows(oldRows));
+
+        QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+        Mirror mirror(&model);
+        QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy moveSpy(&model, &QAbstractItemModel::rowsMoved);
+        QSignalSpy changeSpy(&model, &QAbstractItemModel::dataChanged);
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.setRows(parseRows(newRows));
+
+        QStringList expected;
+        for (const auto &row : parseRows(newRows)) {
+            expected.append(QStringLiteral("%1:%2").arg(row.key).arg(row.value));
+        }
+        QCOMPARE(model.contents(), expected);
+        QCOMPARE(mirror.contents(), expected);
+
+        QCOMPARE(insertSpy.count(), insertions);
+        QCOMPARE(removeSpy.count(), removals);
+        QCOMPARE(moveSpy.count(), moves);
+        QCOMPARE(changeSpy.count(), changes);
+        QCOMPARE(resetSpy.count(), resets);
+    }
+
+    void comparesVariantRows()
+    {
+        // Variants of comparable types are only reported as changed if they differ
+        VariantModel model;
+        model.setRows({ 1, u"a"_qs });
+
+        QSignalSpy changeSpy(&model, &QAbstractItemModel::dataChanged);
+        model.setRows({ 1, u"a"_qs });
+        QCOMPARE(changeSpy.count(), 0);
+        model.setRows({ 1, u"b"_qs });
+        QCOMPARE(changeSpy.count(), 1);
+        QCOMPARE(changeSpy.first().at(0).toModelIndex().row(), 1);
+    }
+};
+
+QTEST_GUILESS_MAIN(ModelDiffTest)
+
+#include "modeldifftest.moc"
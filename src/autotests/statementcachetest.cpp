@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <ThreadedDatabase>
+
+#include "statementcache.h"
+#include "writebatcher.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Entry {
+    using ColumnTypes = std::tuple<int, QString>;
+
+    static Entry fromSql(ColumnTypes columns) {
+        auto [id, text] = columns;
+        return Entry { id, text };
+    }
+
+    bool operator==(const Entry &other) const = default;
+
+    int id;
+    QString text;
+};
+
+}
+
+class StatementCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        QVERIFY(m_directory.isValid());
+
+        DatabaseConfiguration config;
+        config.setDatabaseName(m_directory.filePath(QString::fromLatin1(QTest::currentTestFunction()) + u".sqlite"));
+        config.setType(DatabaseType::SQLite);
+        m_database = ThreadedDatabase::establishConnection(config);
+        m_database->execute(QStringLiteral("create table entries (id Integer primary key not null, text Text not null)")).waitForFinished();
+        m_statements = std::make_unique<StatementCache>(*m_database);
+    }
+
+    void cleanup()
+    {
+        m_statements.reset();
+        m_database.reset();
+    }
+
+    void executeAndRead()
+    {
+        m_statements->execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 1, QStringLiteral("one")).waitForFinished();
+        m_statements->execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 2, QStringLiteral("two")).waitForFinished();
+
+        const auto entries = m_statements->getResults<Entry>(QStringLiteral("select id, text from entries order by id")).result();
+        QCOMPARE(entries, (std::vector<Entry> { { 1, u"one"_qs }, { 2, u"two"_qs } }));
+
+        const auto entry = m_statements->getResult<Entry>(QStringLiteral("select id, text from entries where id = ?"), 2).result();
+        QVERIFY(entry);
+        QCOMPARE(entry->text, u"two"_qs);
+
+        const auto missing = m_statements->getResult<Entry>(QStringLiteral("select id, text from entries where id = ?"), 3).result();
+        QVERIFY(!missing);
+    }
+
+    void statistics()
+    {
+        const auto insert = QStringLiteral("insert into entries (id, text) values (?, ?)");
+        for (int i = 0; i < 3; i++) {
+            m_statements->execute(insert, i, QStringLiteral("text"));
+        }
+        m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).waitForFinished();
+
+        auto statistics = m_statements->statistics().result();
+        std::ranges::sort(statistics, std::less(), &StatementStatistics::sqlQuery);
+        QCOMPARE(int(statistics.size()), 2);
+        QCOMPARE(statistics[0].sqlQuery, insert);
+        QCOMPARE(statistics[0].executions, quint64(3));
+        QVERIFY(statistics[0].maxTime <= statistics[0].totalTime);
+        QCOMPARE(statistics[1].executions, quint64(1));
+    }
+
+    void transaction()
+    {
+        std::vector<std::pair<QString, QVariantList>> statements;
+        for (int i = 0; i < 10; i++) {
+            statements.emplace_back(QStringLiteral("insert into entries (id, text) values (?, ?)"), QVariantList { i, QStringLiteral("text") });
+        }
+
+        auto future = m_statements->executeInTransaction(std::move(statements));
+        future.waitForFinished();
+        QVERIFY(!future.isCanceled());
+        QCOMPARE(future.progressValue(), 10);
+
+        const auto entries = m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).result();
+        QCOMPARE(int(entries.size()), 10);
+    }
+
+    void failedTransaction()
+    {
+        // The second insert violates the primary key
+        std::vector<std::pair<QString, QVariantList>> statements {
+            { QStringLiteral("insert into entries (id, text) values (?, ?)"), { 1, QStringLiteral("one") } },
+            { QStringLiteral("insert into entries (id, text) values (?, ?)"), { 1, QStringLiteral("again") } },
+            { QStringLiteral("insert into entries (id, text) values (?, ?)"), { 2, QStringLiteral("two") } },
+        };
+
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to execute")));
+        auto future = m_statements->executeInTransaction(std::move(statements));
+        future.waitForFinished();
+        QVERIFY(future.isCanceled());
+        QCOMPARE(future.progressValue(), 1);
+
+        const auto entries = m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).result();
+        QVERIFY(entries.empty());
+
+        // The connection is usable again afterwards
+        m_statements->execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 1, QStringLiteral("one")).waitForFinished();
+        QCOMPARE(int(m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).result().size()), 1);
+    }
+
+    void batchWrites()
+    {
+        WriteBatcher batcher(*m_statements, 1h);
+
+        auto first = batcher.execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 1, QStringLiteral("one"));
+        auto second = batcher.execute(QStringLiteral("update entries set text = ? where id = ?"), QStringLiteral("updated"), 1);
+
+        // Nothing is written before the window ends
+        QTest::qWait(10);
+        QVERIFY(!first.isFinished());
+
+        batcher.flush();
+        QTRY_VERIFY(first.isFinished());
+        QVERIFY(second.isFinished());
+        QVERIFY(!first.isCanceled());
+
+        // The statements ran in the order they were queued
+        const auto entries = m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).result();
+        QCOMPARE(entries, (std::vector<Entry> { { 1, u"updated"_qs } }));
+    }
+
+    void batchWindow()
+    {
+        WriteBatcher batcher(*m_statements, 10ms);
+
+        auto future = batcher.execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 1, QStringLiteral("one"));
+        QTRY_VERIFY(future.isFinished());
+        QCOMPARE(int(m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).result().size()), 1);
+    }
+
+    void failedBatch()
+    {
+        WriteBatcher batcher(*m_statements, 1h);
+
+        auto first = batcher.execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 1, QStringLiteral("one"));
+        auto second = batcher.execute(QStringLiteral("insert into missing_table (id) values (?)"), 1);
+
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("^Failed to prepare")));
+        batcher.flush();
+        QTRY_VERIFY(first.isFinished());
+        QVERIFY(first.isCanceled());
+        QVERIFY(second.isCanceled());
+        QVERIFY(m_statements->getResults<Entry>(QStringLiteral("select id, text from entries")).result().empty());
+
+        // The next batch starts over
+        auto third = batcher.execute(QStringLiteral("insert into entries (id, text) values (?, ?)"), 2, QStringLiteral("two"));
+        batcher.flush();
+        QTRY_VERIFY(third.isFinished());
+        QVERIFY(!third.isCanceled());
+    }
+
+private:
+    QTemporaryDir m_directory;
+    std::unique_ptr<ThreadedDatabase> m_database;
+    std::unique_ptr<StatementCache> m_statements;
+};
+
+QTEST_GUILESS_MAIN(StatementCacheTest)
+
+#include "statementcachetest.moc"
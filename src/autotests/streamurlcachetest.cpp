@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "streamurlcache.h"
+
+#include <QDateTime>
+#include <QTest>
+
+namespace {
+
+video_info::Format audioFormat(float quality, qint64 expire)
+{
+    return video_info::Format {
+        .quality = quality,
+        .url = "https://example.org/audio?expire=" + std::to_string(expire),
+        .vcodec = "none",
+        .acodec = "opus",
+    };
+}
+
+qint64 secondsFromNow(qint64 seconds)
+{
+    return QDateTime::currentSecsSinceEpoch() + seconds;
+}
+
+}
+
+class StreamUrlCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void bestAudioFormat()
+    {
+        video_info::VideoInfo info;
+        info.formats = {
+            video_info::Format { .quality = 10, .url = "video", .vcodec = "avc1", .acodec = "mp4a" },
+            audioFormat(2, secondsFromNow(3600)),
+            video_info::Format { .quality = 5, .url = "video only", .vcodec = "vp9", .acodec = "none" },
+            audioFormat(3, secondsFromNow(3600)),
+            audioFormat(1, secondsFromNow(3600)),
+        };
+
+        const auto best = StreamUrlCache::bestAudioFormat(info);
+        QVERIFY(best);
+        QCOMPARE(best->quality.value_or(0), 3.0f);
+
+        QVERIFY(!StreamUrlCache::bestAudioFormat(video_info::VideoInfo {}));
+    }
+
+    void storeOnlyKeepsBestFormat()
+    {
+        video_info::VideoInfo info;
+        info.id = "abc";
+        info.formats = { audioFormat(1, secondsFromNow(3600)), audioFormat(2, secondsFromNow(3600)) };
+
+        StreamUrlCache cache;
+        cache.store(u"abc"_qs, info);
+
+        const auto cached = cache.lookup(u"abc"_qs);
+        QVERIFY(cached);
+        QCOMPARE(QString::fromStdString(cached->id), u"abc"_qs);
+        QCOMPARE(int(cached->formats.size()), 1);
+        QCOMPARE(cached->formats.front().quality.value_or(0), 2.0f);
+
+        QVERIFY(!cache.lookup(u"other"_qs));
+    }
+
+    void skipsExpiringUrls()
+    {
+        StreamUrlCache cache;
+
+        // Expires within the safety margin
+        video_info::VideoInfo expiring;
+        expiring.formats = { audioFormat(1, secondsFromNow(60)) };
+        cache.store(u"expiring"_qs, expiring);
+        QVERIFY(!cache.lookup(u"expiring"_qs));
+
+        video_info::VideoInfo expired;
+        expired.formats = { audioFormat(1, secondsFromNow(-60)) };
+        cache.store(u"expired"_qs, expired);
+        QVERIFY(!cache.lookup(u"expired"_qs));
+    }
+
+    void cachesUrlsWithoutExpiry()
+    {
+        video_info::VideoInfo info;
+        info.formats = { video_info::Format { .quality = 1, .url = "https://example.org/audio", .vcodec = "none", .acodec = "opus" } };
+
+        StreamUrlCache cache;
+        cache.store(u"abc"_qs, info);
+        QVERIFY(cache.lookup(u"abc"_qs));
+    }
+};
+
+QTEST_GUILESS_MAIN(StreamUrlCacheTest)
+
+#include "streamurlcachetest.moc"
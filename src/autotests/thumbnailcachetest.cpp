@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QTest>
+
+#include "thumbnailcache.h"
+
+namespace {
+
+const auto keepNothing = [](const QString &) {
+    return false;
+};
+
+}
+
+class ThumbnailCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void entryName()
+    {
+        QCOMPARE(ThumbnailCache::entryName(u"video"_qs, 35), u"video@64"_qs);
+        QCOMPARE(ThumbnailCache::entryName(u"video"_qs, 64), u"video@64"_qs);
+        QCOMPARE(ThumbnailCache::entryName(u"video"_qs, 65), u"video@200"_qs);
+        QCOMPARE(ThumbnailCache::entryName(u"video"_qs, 600), u"video@600"_qs);
+        // Larger than all buckets
+        QCOMPARE(ThumbnailCache::entryName(u"video"_qs, 2000), u"video@600"_qs);
+    }
+
+    void evictsLeastRecentlyUsed()
+    {
+        const QHash<QString, ThumbnailCache::Entry> index {
+            { u"newest"_qs, { 100, 40 } },
+            { u"oldest"_qs, { 100, 10 } },
+            { u"older"_qs, { 100, 20 } },
+            { u"newer"_qs, { 100, 30 } },
+        };
+
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 400, keepNothing), QStringList());
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 300, keepNothing), QStringList { u"oldest"_qs });
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 250, keepNothing), (QStringList { u"oldest"_qs, u"older"_qs }));
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 0, keepNothing),
+                 (QStringList { u"oldest"_qs, u"older"_qs, u"newer"_qs, u"newest"_qs }));
+    }
+
+    void evictsBySize()
+    {
+        // A large old entry frees enough space on its own
+        const QHash<QString, ThumbnailCache::Entry> index {
+            { u"large"_qs, { 1000, 10 } },
+            { u"small"_qs, { 10, 20 } },
+            { u"medium"_qs, { 100, 30 } },
+        };
+
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 200, keepNothing), QStringList { u"large"_qs });
+    }
+
+    void skipsKeptEntries()
+    {
+        const QHash<QString, ThumbnailCache::Entry> index {
+            { u"oldest"_qs, { 100, 10 } },
+            { u"older"_qs, { 100, 20 } },
+            { u"newer"_qs, { 100, 30 } },
+        };
+
+        const auto keepOldest = [](const QString &name) {
+            return name == u"oldest";
+        };
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 200, keepOldest), QStringList { u"older"_qs });
+        QCOMPARE(ThumbnailCache::leastRecentlyUsed(index, 0, keepOldest), (QStringList { u"older"_qs, u"newer"_qs }));
+    }
+};
+
+QTEST_GUILESS_MAIN(ThumbnailCacheTest)
+
+#include "thumbnailcachetest.moc"
@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QBuffer>
+#include <QFile>
+#include <QImage>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "thumbnailpack.h"
+
+#include <memory>
+
+namespace {
+
+QByteArray pngImage(QRgb color, int size = 64)
+{
+    QImage image(size, size, QImage::Format_ARGB32);
+    image.fill(color);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QBuffer::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data;
+}
+
+}
+
+class ThumbnailPackTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init()
+    {
+        m_directory = std::make_unique<QTemporaryDir>();
+        QVERIFY(m_directory->isValid());
+    }
+
+    void roundTrip()
+    {
+        ThumbnailPack pack(m_directory->path());
+        QVERIFY(pack.open().isEmpty());
+
+        const auto red = pngImage(qRgb(255, 0, 0));
+        const auto blue = pngImage(qRgb(0, 0, 255));
+        QVERIFY(pack.append(u"red"_qs, red) > red.size());
+        QVERIFY(pack.append(u"blue"_qs, blue) > blue.size());
+
+        QCOMPARE(pack.image(u"red"_qs), QImage::fromData(red));
+        QCOMPARE(pack.image(u"blue"_qs), QImage::fromData(blue));
+        QVERIFY(pack.image(u"missing"_qs).isNull());
+    }
+
+    void replace()
+    {
+        ThumbnailPack pack(m_directory->path());
+        pack.open();
+
+        const auto blue = pngImage(qRgb(0, 0, 255));
+        pack.append(u"image"_qs, pngImage(qRgb(255, 0, 0)));
+        pack.append(u"image"_qs, blue);
+
+        QCOMPARE(pack.image(u"image"_qs), QImage::fromData(blue));
+    }
+
+    void reopen()
+    {
+        const auto red = pngImage(qRgb(255, 0, 0));
+        qint64 size = 0;
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            size = pack.append(u"red"_qs, red);
+            pack.saveIndex();
+        }
+
+        ThumbnailPack pack(m_directory->path());
+        const auto sizes = pack.open();
+        QCOMPARE(sizes.size(), 1);
+        QCOMPARE(sizes.value(u"red"_qs), size);
+        QCOMPARE(pack.image(u"red"_qs), QImage::fromData(red));
+    }
+
+    void recoverWithoutIndex()
+    {
+        const auto red = pngImage(qRgb(255, 0, 0));
+        const auto blue = pngImage(qRgb(0, 0, 255));
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            pack.append(u"red"_qs, red);
+            pack.saveIndex();
+            // Appended after the index was saved
+            pack.append(u"blue"_qs, blue);
+        }
+
+        ThumbnailPack pack(m_directory->path());
+        const auto sizes = pack.open();
+        QCOMPARE(sizes.size(), 2);
+        QCOMPARE(pack.image(u"red"_qs), QImage::fromData(red));
+        QCOMPARE(pack.image(u"blue"_qs), QImage::fromData(blue));
+    }
+
+    void cutOffIncompleteRecord()
+    {
+        const auto red = pngImage(qRgb(255, 0, 0));
+        const QString packFile = m_directory->filePath(QStringLiteral("thumbnails.pack"));
+        qint64 headerSize = 0;
+        qint64 redSize = 0;
+        qint64 blueSize = 0;
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            headerSize = QFile(packFile).size();
+            redSize = pack.append(u"red"_qs, red);
+            pack.saveIndex();
+            blueSize = pack.append(u"blue"_qs, pngImage(qRgb(0, 0, 255)));
+        }
+        {
+            // Simulates a crash while the last record was written
+            QFile file(packFile);
+            QVERIFY(file.open(QFile::ReadWrite));
+            QVERIFY(file.resize(headerSize + redSize + blueSize - 10));
+        }
+
+        ThumbnailPack pack(m_directory->path());
+        const auto sizes = pack.open();
+        QCOMPARE(sizes.keys(), QStringList { u"red"_qs });
+        QCOMPARE(pack.image(u"red"_qs), QImage::fromData(red));
+        QCOMPARE(QFile(packFile).size(), headerSize + redSize);
+
+        // Appending continues after the last complete record
+        const auto green = pngImage(qRgb(0, 255, 0));
+        QVERIFY(pack.append(u"green"_qs, green) > 0);
+        QCOMPARE(pack.image(u"green"_qs), QImage::fromData(green));
+    }
+
+    void growsInAdvance()
+    {
+        const QString packFile = m_directory->filePath(QStringLiteral("thumbnails.pack"));
+        const auto red = pngImage(qRgb(255, 0, 0));
+        qint64 headerSize = 0;
+        qint64 redSize = 0;
+        qint64 blueSize = 0;
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            headerSize = QFile(packFile).size();
+            redSize = pack.append(u"red"_qs, red);
+
+            // The file has room for more records, so appending doesn't replace the mapping every time
+            const qint64 capacity = QFile(packFile).size();
+            QVERIFY(capacity > headerSize + 2 * redSize);
+            blueSize = pack.append(u"blue"_qs, pngImage(qRgb(0, 0, 255)));
+            QVERIFY(blueSize > 0);
+            QCOMPARE(QFile(packFile).size(), capacity);
+            QCOMPARE(pack.image(u"red"_qs), QImage::fromData(red));
+        }
+
+        // The space is cut off again, without losing records
+        ThumbnailPack pack(m_directory->path());
+        QCOMPARE(pack.open().size(), 2);
+        QCOMPARE(QFile(packFile).size(), headerSize + redSize + blueSize);
+        QCOMPARE(pack.image(u"red"_qs), QImage::fromData(red));
+    }
+
+    void corruptedRecord()
+    {
+        const auto red = pngImage(qRgb(255, 0, 0));
+        const QString packFile = m_directory->filePath(QStringLiteral("thumbnails.pack"));
+        qint64 end = 0;
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            end = QFile(packFile).size();
+            end += pack.append(u"red"_qs, red);
+            pack.saveIndex();
+        }
+        {
+            // The last byte of the image data
+            QFile file(packFile);
+            QVERIFY(file.open(QFile::ReadWrite));
+            QVERIFY(file.seek(end - 1));
+            QVERIFY(file.putChar(char(~red.back())));
+        }
+
+        ThumbnailPack pack(m_directory->path());
+        pack.open();
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(QStringLiteral("is corrupted")));
+        QVERIFY(pack.image(u"red"_qs).isNull());
+    }
+
+    void removeAndCompact()
+    {
+        const QString packFile = m_directory->filePath(QStringLiteral("thumbnails.pack"));
+        const auto kept = pngImage(qRgb(0, 255, 0), 128);
+
+        ThumbnailPack pack(m_directory->path());
+        pack.open();
+        for (int i = 0; i < 10; i++) {
+            pack.append(QString::number(i), pngImage(qRgb(i * 20, 0, 0), 128));
+        }
+        pack.append(u"kept"_qs, kept);
+
+        // Too little of the pack is unused to be worth compacting
+        const qint64 fullSize = QFile(packFile).size();
+        pack.remove({ u"0"_qs });
+        pack.compact();
+        QCOMPARE(QFile(packFile).size(), fullSize);
+        QVERIFY(pack.image(u"0"_qs).isNull());
+
+        QStringList removed;
+        for (int i = 1; i < 10; i++) {
+            removed.append(QString::number(i));
+        }
+        pack.remove(removed);
+        pack.compact();
+
+        QVERIFY(QFile(packFile).size() < fullSize / 2);
+        QCOMPARE(pack.image(u"kept"_qs), QImage::fromData(kept));
+        QVERIFY(pack.image(u"5"_qs).isNull());
+
+        // Appending works on the compacted pack
+        const auto added = pngImage(qRgb(0, 0, 255));
+        QVERIFY(pack.append(u"added"_qs, added) > 0);
+        QCOMPARE(pack.image(u"added"_qs), QImage::fromData(added));
+    }
+
+    void keepsRecordsAppendedAfterRevision()
+    {
+        ThumbnailPack pack(m_directory->path());
+        pack.open();
+
+        pack.append(u"removed"_qs, pngImage(qRgb(255, 0, 0)));
+        pack.append(u"appendedAgain"_qs, pngImage(qRgb(255, 0, 0)));
+        const quint64 revision = pack.revision();
+
+        // Written again while the removal was queued
+        const auto blue = pngImage(qRgb(0, 0, 255));
+        pack.append(u"appendedAgain"_qs, blue);
+        QVERIFY(pack.revision() > revision);
+
+        pack.remove({ u"removed"_qs, u"appendedAgain"_qs }, revision);
+        QVERIFY(pack.image(u"removed"_qs).isNull());
+        QCOMPARE(pack.image(u"appendedAgain"_qs), QImage::fromData(blue));
+    }
+
+    void reopenAfterCompact()
+    {
+        const auto kept = pngImage(qRgb(0, 255, 0));
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            for (int i = 0; i < 10; i++) {
+                pack.append(QString::number(i), pngImage(qRgb(i * 20, 0, 0)));
+            }
+            pack.append(u"kept"_qs, kept);
+            pack.saveIndex();
+
+            QStringList removed;
+            for (int i = 0; i < 10; i++) {
+                removed.append(QString::number(i));
+            }
+            pack.remove(removed);
+            pack.compact();
+        }
+
+        // The index of the compacted pack is used, not the one saved before compacting
+        ThumbnailPack pack(m_directory->path());
+        const auto sizes = pack.open();
+        QCOMPARE(sizes.keys(), QStringList { u"kept"_qs });
+        QCOMPARE(pack.image(u"kept"_qs), QImage::fromData(kept));
+    }
+
+    void clear()
+    {
+        {
+            ThumbnailPack pack(m_directory->path());
+            pack.open();
+            pack.append(u"red"_qs, pngImage(qRgb(255, 0, 0)));
+            pack.saveIndex();
+        }
+
+        ThumbnailPack::clear(m_directory->path());
+
+        ThumbnailPack pack(m_directory->path());
+        QVERIFY(pack.open().isEmpty());
+    }
+
+private:
+    std::unique_ptr<QTemporaryDir> m_directory;
+};
+
+QTEST_GUILESS_MAIN(ThumbnailPackTest)
+
+#include "thumbnailpacktest.moc"
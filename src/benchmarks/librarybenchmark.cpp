@@ -0,0 +1,301 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringBuilder>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <ThreadedDatabase>
+
+#include "libraryqueries.h"
+#include "statementcache.h"
+
+#include <array>
+#include <memory>
+#include <tuple>
+
+namespace {
+
+constexpr int SONGS = 100'000;
+constexpr int FAVOURITES = 10'000;
+constexpr int SEARCHES = 10'000;
+
+constexpr std::array WORDS = {
+    "love", "night", "heart", "summer", "dance", "fire", "river", "dream", "light", "rain",
+    "city", "blue", "gold", "wild", "home", "road", "moon", "song", "time", "storm",
+};
+
+template <typename ...Columns>
+struct Row {
+    using ColumnTypes = std::tuple<Columns...>;
+
+    static Row fromSql(ColumnTypes columns) {
+        return Row { std::move(columns) };
+    }
+
+    ColumnTypes columns;
+};
+
+using SongRow = Row<QString, QString, QString, QString>;
+using PlayedRow = Row<QString, int, QString, QString, QString>;
+
+struct ImportedSong {
+    QString videoId;
+    QString title;
+    QString artist;
+    QString album;
+};
+
+QString videoId(int i)
+{
+    return u"video" % QString::number(i).rightJustified(6, u'0');
+}
+
+QString words(QRandomGenerator &random, int count)
+{
+    QStringList result;
+    for (int i = 0; i < count; i++) {
+        result.append(QString::fromLatin1(WORDS[random.bounded(int(WORDS.size()))]));
+    }
+    return result.join(u' ');
+}
+
+}
+
+///
+/// Times every query Library runs, on a library with 100000 played songs,
+/// and how many tracks per second importing a playlist writes.
+///
+class LibraryBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_directory.isValid());
+
+        DatabaseConfiguration config;
+        config.setDatabaseName(m_directory.filePath(QStringLiteral("library.sqlite")));
+        config.setType(DatabaseType::SQLite);
+        m_database = ThreadedDatabase::establishConnection(config);
+        m_database->runMigrations(QStringLiteral(MIGRATIONS_DIR));
+        for (const char *trigger : queries::FULL_TEXT_TRIGGERS) {
+            m_database->execute(QString::fromLatin1(trigger));
+        }
+        m_statements = std::make_unique<StatementCache>(*m_database);
+
+        // Always the same library, so results can be compared between runs
+        QRandomGenerator random(42);
+
+        std::vector<std::pair<QString, QVariantList>> statements;
+        statements.reserve(SONGS * 2 + FAVOURITES + SEARCHES);
+        for (int i = 0; i < SONGS; i++) {
+            statements.emplace_back(QString::fromLatin1(queries::ADD_SONG),
+                                    QVariantList { videoId(i), words(random, 3), words(random, 2), words(random, 2) });
+            // Plays follow a long tail, like in a real library
+            const int plays = 1 + int(1000 / (1 + random.bounded(1000)));
+            const auto lastPlayed = QDateTime::currentDateTimeUtc().addSecs(-random.bounded(365 * 24 * 60 * 60));
+            statements.emplace_back(QStringLiteral("insert into played_songs (video_id, plays, last_played) values (?, ?, ?)"),
+                                    QVariantList { videoId(i), plays, lastPlayed });
+        }
+        for (int i = 0; i < FAVOURITES; i++) {
+            statements.emplace_back(QString::fromLatin1(queries::ADD_FAVOURITE), QVariantList { videoId(random.bounded(SONGS)) });
+        }
+        for (int i = 0; i < SEARCHES; i++) {
+            statements.emplace_back(QString::fromLatin1(queries::ADD_SEARCH), QVariantList { words(random, 2) });
+        }
+        m_statements->executeInTransaction(std::move(statements)).waitForFinished();
+        m_database->execute(QStringLiteral("analyze")).waitForFinished();
+
+        const auto songs = m_statements->getResult<Row<int>>(QStringLiteral("select count(*) from played_songs")).result();
+        QVERIFY(songs);
+        QCOMPARE(std::get<0>(songs->columns), SONGS);
+    }
+
+    void cleanupTestCase()
+    {
+        m_statements.reset();
+        m_database.reset();
+    }
+
+    void favouriteIds()
+    {
+        QBENCHMARK {
+            m_statements->getResults<SingleValue<QString>>(queries::FAVOURITE_IDS).waitForFinished();
+        }
+    }
+
+    void favourites()
+    {
+        QBENCHMARK {
+            m_statements->getResults<SongRow>(queries::FAVOURITES).waitForFinished();
+        }
+    }
+
+    void playedIds()
+    {
+        QBENCHMARK {
+            m_statements->getResults<SingleValue<QString>>(queries::PLAYED_IDS).waitForFinished();
+        }
+    }
+
+    void playbackHistory()
+    {
+        QBENCHMARK {
+            m_statements->getResults<PlayedRow>(queries::PLAYBACK_HISTORY).waitForFinished();
+        }
+    }
+
+    void mostPlayed()
+    {
+        QBENCHMARK {
+            m_statements->getResults<PlayedRow>(queries::MOST_PLAYED).waitForFinished();
+        }
+    }
+
+    void playedSong()
+    {
+        int i = 0;
+        QBENCHMARK {
+            m_statements->getResult<PlayedRow>(queries::PLAYED_SONG, videoId(i++ % SONGS)).waitForFinished();
+        }
+    }
+
+    void searchPlayed()
+    {
+        QBENCHMARK {
+            m_statements->getResults<PlayedRow>(queries::SEARCH_PLAYED, QStringLiteral("\"love\"* \"ni\"*")).waitForFinished();
+        }
+    }
+
+    void searchHistory()
+    {
+        QBENCHMARK {
+            m_statements->getResults<SingleValue<QString>>(queries::SEARCH_HISTORY).waitForFinished();
+        }
+    }
+
+    void searchHistoryMatching()
+    {
+        QBENCHMARK {
+            m_statements->getResults<SingleValue<QString>>(queries::SEARCH_HISTORY_MATCHING, QStringLiteral("\"dre\"*")).waitForFinished();
+        }
+    }
+
+    void addSong()
+    {
+        int i = 0;
+        QBENCHMARK {
+            const auto id = videoId(i++ % SONGS);
+            m_statements->execute(queries::ADD_SONG, id, QStringLiteral("Title"), QStringLiteral("Artist"), QStringLiteral("Album"))
+                .waitForFinished();
+        }
+    }
+
+    void addPlay()
+    {
+        int i = 0;
+        QBENCHMARK {
+            m_statements->execute(queries::ADD_PLAY, videoId(i++ % SONGS)).waitForFinished();
+        }
+    }
+
+    // Removing and adding again, so the library keeps its size
+
+    void removeAndAddPlay()
+    {
+        int i = 0;
+        QBENCHMARK {
+            const auto id = videoId(i++ % SONGS);
+            m_statements->execute(queries::REMOVE_PLAYED, id);
+            m_statements->execute(queries::ADD_PLAY, id).waitForFinished();
+        }
+    }
+
+    void addAndRemoveFavourite()
+    {
+        // Not one of the seeded favourites, which would be missing afterwards
+        const auto id = videoId(SONGS);
+        QBENCHMARK {
+            m_statements->execute(queries::ADD_FAVOURITE, id);
+            m_statements->execute(queries::REMOVE_FAVOURITE, id).waitForFinished();
+        }
+    }
+
+    void addAndRemoveSearch()
+    {
+        QBENCHMARK {
+            m_statements->execute(queries::ADD_SEARCH, QStringLiteral("benchmark search"));
+            m_statements->execute(queries::REMOVE_SEARCH, QStringLiteral("benchmark search")).waitForFinished();
+        }
+    }
+
+    void importPlaylist_data()
+    {
+        QTest::addColumn<int>("tracks");
+        QTest::addColumn<bool>("bulk");
+
+        for (int tracks : { 100, 1000, 5000 }) {
+            QTest::addRow("%d tracks, bulk", tracks) << tracks << true;
+            QTest::addRow("%d tracks, statement per track", tracks) << tracks << false;
+        }
+    }
+
+    void importPlaylist()
+    {
+        QFETCH(int, tracks);
+        QFETCH(bool, bulk);
+
+        QRandomGenerator random(42);
+        qint64 imported = 0;
+        qint64 elapsed = 0;
+
+        QBENCHMARK {
+            // Every time a new playlist, with songs that are not in the library yet
+            const auto playlist = m_statements->getResult<SingleValue<qint64>>(
+                QStringLiteral("insert into playlists (title) values (?) returning playlist_id"), QStringLiteral("Benchmark")).result();
+            QVERIFY(playlist);
+
+            std::vector<ImportedSong> songs;
+            songs.reserve(tracks);
+            for (int i = 0; i < tracks; i++) {
+                songs.push_back(ImportedSong { videoId(m_nextSong++), words(random, 3), words(random, 2), words(random, 2) });
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            if (bulk) {
+                m_statements->executeInTransaction(queries::addPlaylistEntries(playlist->value, songs)).waitForFinished();
+            } else {
+                // Like importing did before, each statement in its own transaction
+                QFuture<void> written;
+                for (const auto &song : songs) {
+                    m_statements->execute(queries::ADD_SONG, song.videoId, song.title, song.artist, song.album);
+                    written = m_statements->execute(QStringLiteral("insert or ignore into playlist_entries (playlist_id, video_id) values (?, ?)"),
+                                                    playlist->value, song.videoId);
+                }
+                written.waitForFinished();
+            }
+            elapsed += timer.nsecsElapsed();
+            imported += tracks;
+        }
+
+        qInfo("%.0f tracks per second", double(imported) * 1e9 / double(elapsed));
+    }
+
+private:
+    QTemporaryDir m_directory;
+    std::unique_ptr<ThreadedDatabase> m_database;
+    std::unique_ptr<StatementCache> m_statements;
+    // Songs after the seeded ones, and the favourite used by addAndRemoveFavourite
+    int m_nextSong = SONGS + 1;
+};
+
+QTEST_GUILESS_MAIN(LibraryBenchmark)
+
+#include "librarybenchmark.moc"
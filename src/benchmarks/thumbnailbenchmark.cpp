@@ -0,0 +1,265 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QBuffer>
+#include <QImage>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimer>
+
+#include "thumbnailcache.h"
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Roughly the time it takes to download a thumbnail
+constexpr auto DOWNLOAD_LATENCY = 30ms;
+// Rows of a list that are on screen at once
+constexpr int VISIBLE_ROWS = 10;
+// Delegate size of list rows, which is what the queue requests
+constexpr int ROW_THUMBNAIL_SIZE = 64;
+
+///
+/// Answers a request after a fixed latency, without any network access
+///
+class FakeReply : public QNetworkReply
+{
+public:
+    FakeReply(const QNetworkRequest &request, const QByteArray &data, QObject *parent)
+        : QNetworkReply(parent)
+        , m_data(data)
+    {
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(QNetworkAccessManager::GetOperation);
+        open(QIODevice::ReadOnly);
+
+        m_timer.setSingleShot(true);
+        connect(&m_timer, &QTimer::timeout, this, [this] {
+            setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+            setFinished(true);
+            Q_EMIT metaDataChanged();
+            Q_EMIT readyRead();
+            Q_EMIT finished();
+        });
+        m_timer.start(DOWNLOAD_LATENCY);
+    }
+
+    void abort() override
+    {
+        if (isFinished()) {
+            return;
+        }
+        m_timer.stop();
+        m_data.clear();
+        setError(OperationCanceledError, QStringLiteral("Operation canceled"));
+        setFinished(true);
+        Q_EMIT errorOccurred(OperationCanceledError);
+        Q_EMIT finished();
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_data.size() - m_offset + QNetworkReply::bytesAvailable();
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (!isFinished() || m_offset >= m_data.size()) {
+            return isFinished() ? -1 : 0;
+        }
+        const qint64 size = std::min<qint64>(maxSize, m_data.size() - m_offset);
+        std::memcpy(data, m_data.constData() + m_offset, size);
+        m_offset += size;
+        return size;
+    }
+
+private:
+    QByteArray m_data;
+    qint64 m_offset = 0;
+    QTimer m_timer;
+};
+
+class FakeNetworkAccessManager : public QNetworkAccessManager
+{
+public:
+    explicit FakeNetworkAccessManager(const QByteArray &image)
+        : m_image(image)
+    {
+    }
+
+    int requests = 0;
+
+protected:
+    QNetworkReply *createRequest(Operation, const QNetworkRequest &request, QIODevice *) override
+    {
+        requests++;
+        return new FakeReply(request, m_image, this);
+    }
+
+private:
+    QByteArray m_image;
+};
+
+/// An image of the size of YouTube's maxresdefault thumbnails, which is not trivial to compress
+QByteArray thumbnailImage()
+{
+    QImage image(1280, 720, QImage::Format_RGB32);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, 1280, 720);
+    gradient.setColorAt(0, Qt::darkBlue);
+    gradient.setColorAt(1, Qt::darkRed);
+    painter.fillRect(image.rect(), gradient);
+    for (int i = 0; i < 200; i++) {
+        painter.setPen(QColor::fromHsv(i * 7 % 360, 200, 200));
+        painter.drawEllipse(QPoint(i * 37 % 1280, i * 53 % 720), i % 90, i % 70);
+    }
+    painter.end();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QBuffer::WriteOnly);
+    image.save(&buffer, "JPG");
+    return data;
+}
+
+}
+
+///
+/// Measures how long the thumbnails of a list take to appear after a fling.
+///
+/// A fling requests the thumbnails of all rows that scroll past, and releases them once the rows leave the screen.
+/// Only the rows the list stops at are visible, so the time until their thumbnails are ready is the latency users notice.
+///
+class ThumbnailBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_directory.isValid());
+        m_nam = std::make_unique<FakeNetworkAccessManager>(thumbnailImage());
+        m_cache = std::make_unique<ThumbnailCache>(m_directory.path(), *m_nam);
+    }
+
+    void cleanupTestCase()
+    {
+        m_cache.reset();
+        m_nam.reset();
+    }
+
+    void fling_data()
+    {
+        QTest::addColumn<int>("rows");
+
+        QTest::addRow("%d rows", 50) << 50;
+        QTest::addRow("%d rows", 500) << 500;
+    }
+
+    void fling()
+    {
+        QFETCH(int, rows);
+
+        int downloads = 0;
+        QBENCHMARK {
+            const int requestsBefore = m_nam->requests;
+
+            // Rows that were not shown before, so nothing is cached yet
+            std::deque<std::pair<QString, QFuture<QString>>> visible;
+            for (int i = 0; i < rows; i++) {
+                const auto videoId = QStringLiteral("fling%1").arg(m_nextVideo++);
+                visible.emplace_back(videoId, m_cache->thumbnail(videoId, ROW_THUMBNAIL_SIZE));
+                if (visible.size() > VISIBLE_ROWS) {
+                    m_cache->release(visible.front().first, ROW_THUMBNAIL_SIZE);
+                    visible.pop_front();
+                }
+            }
+
+            for (const auto &[videoId, future] : visible) {
+                QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 10000);
+                QVERIFY(!future.result().isEmpty());
+            }
+
+            downloads += m_nam->requests - requestsBefore;
+        }
+
+        // Rows that scrolled past should barely cause any downloads
+        qInfo("%d downloads for %d rows of which %d are visible", downloads, rows, VISIBLE_ROWS);
+    }
+
+    void scaleDown()
+    {
+        // Small sizes are created from the largest one, when it is already cached
+        std::vector<QString> videoIds;
+        for (int i = 0; i < 50; i++) {
+            videoIds.push_back(QStringLiteral("scale%1").arg(m_nextVideo++));
+            auto largest = m_cache->thumbnail(videoIds.back(), ThumbnailCache::SIZE_BUCKETS.back());
+            QTRY_VERIFY_WITH_TIMEOUT(largest.isFinished(), 10000);
+        }
+        const int requestsBefore = m_nam->requests;
+
+        QBENCHMARK_ONCE {
+            std::vector<QFuture<QString>> futures;
+            for (const auto &videoId : videoIds) {
+                futures.push_back(m_cache->thumbnail(videoId, ROW_THUMBNAIL_SIZE));
+            }
+            for (const auto &future : futures) {
+                QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 10000);
+                QVERIFY(!future.result().isEmpty());
+            }
+        }
+
+        QCOMPARE(m_nam->requests, requestsBefore);
+    }
+
+    void cachedLookup()
+    {
+        const auto videoId = QStringLiteral("cached%1").arg(m_nextVideo++);
+        auto first = m_cache->thumbnail(videoId, ROW_THUMBNAIL_SIZE);
+        QTRY_VERIFY_WITH_TIMEOUT(first.isFinished(), 10000);
+
+        QBENCHMARK {
+            auto future = m_cache->thumbnail(videoId, ROW_THUMBNAIL_SIZE);
+            QVERIFY(future.isFinished());
+        }
+    }
+
+    void decodeCached()
+    {
+        const auto videoId = QStringLiteral("decode%1").arg(m_nextVideo++);
+        auto future = m_cache->thumbnail(videoId, ROW_THUMBNAIL_SIZE);
+        QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 10000);
+
+        QBENCHMARK {
+            QVERIFY(!m_cache->image(future.result()).isNull());
+        }
+    }
+
+private:
+    QTemporaryDir m_directory;
+    std::unique_ptr<FakeNetworkAccessManager> m_nam;
+    std::unique_ptr<ThumbnailCache> m_cache;
+    int m_nextVideo = 0;
+};
+
+QTEST_MAIN(ThumbnailBenchmark)
+
+#include "thumbnailbenchmark.moc"
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include <QTest>
+
+#include <pybind11/embed.h>
+
+#include <ytmusic.h>
+#include <ytmusicconversion.h>
+
+#include <memory>
+
+namespace py = pybind11;
+
+using namespace py::literals;
+
+// Shaped like the result of ytmusicapi's get_playlist, after its post-processing
+constexpr auto MAKE_PLAYLIST = R"(
+def make_playlist(count):
+    thumbnails = [
+        {"url": "https://lh3.googleusercontent.com/benchmark=w60-h60-l90-rj", "width": 60, "height": 60},
+        {"url": "https://lh3.googleusercontent.com/benchmark=w120-h120-l90-rj", "width": 120, "height": 120},
+    ]
+    return {
+        "id": "PLbenchmark",
+        "privacy": "PUBLIC",
+        "title": "Benchmark",
+        "thumbnails": thumbnails,
+        "description": None,
+        "author": {"name": "Benchmark", "id": "UCbenchmark"},
+        "year": "2026",
+        "duration": "70+ hours",
+        "trackCount": count,
+        "tracks": [{
+            "videoId": f"video{i:06}",
+            "title": f"Track number {i} – ünïcödé",
+            "artists": [{"name": "Artist", "id": "UCartist"}, {"name": "Featured artist", "id": None}],
+            "album": {"name": "Album", "id": "MPREbenchmark"},
+            "likeStatus": "INDIFFERENT",
+            "inLibrary": None,
+            "thumbnails": thumbnails,
+            "isAvailable": True,
+            "isExplicit": i % 3 == 0,
+            "videoType": "MUSIC_VIDEO_TYPE_ATV",
+            "duration": "3:45",
+            "duration_seconds": 225,
+            "setVideoId": f"set{i:06}",
+        } for i in range(count)],
+    }
+)";
+
+///
+/// Compares converting a playlist by walking the Python objects with serializing it to JSON in Python
+/// and parsing that without the GIL. jsonSerialize measures how long the GIL is held on the JSON path.
+///
+class YTMusicConversionBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        // Initializes the interpreter
+        m_ytmusic = std::make_unique<YTMusic>();
+
+        py::gil_scoped_acquire gil;
+        py::exec(MAKE_PLAYLIST);
+    }
+
+    void objects_data() { trackCounts(); }
+    void objects()
+    {
+        QFETCH(int, tracks);
+        py::gil_scoped_acquire gil;
+        const auto playlist = makePlaylist(tracks);
+
+        QBENCHMARK {
+            const auto converted = conversion::playlist_from_objects(playlist);
+            QCOMPARE(converted.tracks.size(), size_t(tracks));
+        }
+    }
+
+    void json_data() { trackCounts(); }
+    void json()
+    {
+        QFETCH(int, tracks);
+        py::gil_scoped_acquire gil;
+        const auto playlist = makePlaylist(tracks);
+
+        QBENCHMARK {
+            const auto text = conversion::to_json(playlist);
+
+            py::gil_scoped_release release;
+            const auto converted = conversion::playlist_from_json(text);
+            QCOMPARE(converted.tracks.size(), size_t(tracks));
+        }
+    }
+
+    void jsonSerialize_data() { trackCounts(); }
+    void jsonSerialize()
+    {
+        QFETCH(int, tracks);
+        py::gil_scoped_acquire gil;
+        const auto playlist = makePlaylist(tracks);
+
+        QBENCHMARK {
+            const auto text = conversion::to_json(playlist);
+            QVERIFY(!text.empty());
+        }
+    }
+
+    void sameResult()
+    {
+        py::gil_scoped_acquire gil;
+        const auto playlist = makePlaylist(10);
+
+        const auto fromObjects = conversion::playlist_from_objects(playlist);
+        const auto fromJson = conversion::playlist_from_json(conversion::to_json(playlist));
+        QCOMPARE(fromJson.track_count, fromObjects.track_count);
+        QCOMPARE(fromJson.tracks.size(), fromObjects.tracks.size());
+        for (size_t i = 0; i < fromObjects.tracks.size(); i++) {
+            QCOMPARE(fromJson.tracks[i].title, fromObjects.tracks[i].title);
+            QCOMPARE(fromJson.tracks[i].video_id, fromObjects.tracks[i].video_id);
+            QCOMPARE(fromJson.tracks[i].artists.size(), fromObjects.tracks[i].artists.size());
+            QCOMPARE(fromJson.tracks[i].artists[1].id, fromObjects.tracks[i].artists[1].id);
+            QCOMPARE(fromJson.tracks[i].is_explicit, fromObjects.tracks[i].is_explicit);
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        m_ytmusic.reset();
+    }
+
+private:
+    static void trackCounts()
+    {
+        QTest::addColumn<int>("tracks");
+        QTest::newRow("100 tracks") << 100;
+        QTest::newRow("1024 tracks") << 1024;
+    }
+
+    static py::object makePlaylist(int tracks)
+    {
+        return py::globals()["make_playlist"](tracks);
+    }
+
+    std::unique_ptr<YTMusic> m_ytmusic;
+};
+
+QTEST_GUILESS_MAIN(YTMusicConversionBenchmark)
+
+#include "ytmusicconversionbenchmark.moc"
@@ -519,27 +519,8 @@ Kirigami.ScrollablePage {
 
                     LocalPlaylistsModel{id:localPlaylistModel}
 
-                    ThumbnailSource {
-                        id: thumbnailSource1
-                        videoId: thumbnailIds[0]
-                    }
-                    ThumbnailSource {
-                        id: thumbnailSource2
-                        videoId: thumbnailIds[1] ?? thumbnailIds[0]
-                    }
-                    ThumbnailSource {
-                        id: thumbnailSource3
-                        videoId: thumbnailIds[2] ?? thumbnailIds[0]
-                    }
-                    ThumbnailSource {
-                        id: thumbnailSource4
-                        videoId: thumbnailIds[3] ?? thumbnailIds[0]
-                    }
                     contentItem: PlaylistCover {
-                        source1: thumbnailSource1.cachedPath
-                        source2: thumbnailSource2.cachedPath
-                        source3: thumbnailSource3.cachedPath
-                        source4: thumbnailSource4.cachedPath
+                        videoIds: thumbnailIds
                         title: playlistDelegate.title
                         height: 200
                         width: height
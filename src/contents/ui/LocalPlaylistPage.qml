@@ -140,6 +140,7 @@ Kirigami.ScrollablePage {
                         id: thumbnailSource
 
                         videoId: delegateItem.videoId
+                        size: 35
                     }
 
                     RoundedImage {
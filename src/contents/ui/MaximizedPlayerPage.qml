@@ -907,6 +907,7 @@ Item {
                                     ThumbnailSource {
                                         id: delegateThumbnailSource
                                         videoId: delegateItem.videoId
+                                        size: delegateItem.height
                                     }
                                     RoundedImage {
                                         source: delegateThumbnailSource.cachedPath
@@ -1150,6 +1151,7 @@ Item {
                                 ThumbnailSource {
                                     id: drawerDelegateThumbnailSource
                                     videoId: drawerDelegateItem.videoId
+                                    size: 50
                                 }
                                 RoundedImage {
                                     source: drawerDelegateThumbnailSource.cachedPath
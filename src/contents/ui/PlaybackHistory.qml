@@ -163,6 +163,7 @@ Kirigami.ScrollablePage {
                         id: thumbnailSource
 
                         videoId: delegateItem.videoId
+                        size: 35
                     }
 
                     RoundedImage {
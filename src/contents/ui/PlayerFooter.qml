@@ -111,6 +111,8 @@ Flickable {
     ThumbnailSource {
         id: thumbnailSource
         videoId: UserPlaylistModel.currentVideoId
+        // Also shown as the large cover of the maximized player
+        size: 600
     }
     
     property var audioPlayer: audioLoader.item
@@ -7,12 +7,11 @@ import QtQuick.Window 2.15
 import Qt5Compat.GraphicalEffects
 import QtQuick.Controls 2.15 as Controls
 
+import org.kde.ytmusic 1.0
+
 Item {
     property alias radius: mask.radius
-    property alias source1: image1.source
-    property alias source2: image2.source
-    property alias source3: image3.source
-    property alias source4: image4.source
+    property alias videoIds: coverSource.videoIds
     property string title
 
     id: icon
@@ -20,107 +19,49 @@ Item {
     layer.effect: OpacityMask {
         maskSource: mask
     }
-    Rectangle{
-        anchors.fill: parent
-        color: Qt.rgba(Math.random(),Math.random(),Math.random(),0.4);
-    }
-    Image {
-        id:image1
-        anchors.top: parent.top
-        anchors.left: parent.left
-        width: parent.width/2
-        height: parent.height/2
-        fillMode: Image.PreserveAspectCrop
-        asynchronous: true
-        sourceSize.width: parent.implicitWidth * Screen.devicePixelRatio
-        Controls.Label{
-            z:-1
-            text: icon.title.charAt(0)
-            anchors.centerIn: parent
-            color: "White"
-            font.pixelSize: 40
-            font.capitalization: Font.AllUppercase
-            font.family: "Noto Serif"
-            font.bold: true
-            enabled: false
 
-        }
+    PlaylistCoverSource {
+        id: coverSource
     }
-    Image {
-        id:image2
-        anchors.top: parent.top
-        anchors.right: parent.right
-        width: parent.width/2
-        height: parent.height/2
-        fillMode: Image.PreserveAspectCrop
-        asynchronous: true
-        sourceSize.width: parent.implicitWidth * Screen.devicePixelRatio
-        Controls.Label{
-            z:-1
-            text: icon.title.charAt(1)
-            anchors.centerIn: parent
-            color: "White"
-            font.pixelSize: 40
-            font.capitalization: Font.AllUppercase
-            font.family: "Noto Serif"
-            font.bold: true
-            enabled: false
-
-        }
 
+    Rectangle{
+        anchors.fill: parent
+        color: Qt.rgba(Math.random(),Math.random(),Math.random(),0.4);
     }
-    Image {
-        id:image3
-        anchors.bottom: parent.bottom
-        anchors.left: parent.left
-        width: parent.width/2
-        height: parent.height/2
-        fillMode: Image.PreserveAspectCrop
-        asynchronous: true
-        sourceSize.width: parent.implicitWidth * Screen.devicePixelRatio
-        Controls.Label{
-            z:-1
-            text: icon.title.charAt(2)
-            anchors.centerIn: parent
-            color: "White"
-            font.pixelSize: 40
-            font.capitalization: Font.AllUppercase
-            font.family: "Noto Serif"
-            font.bold: true
-            enabled: false
+    Grid {
+        anchors.fill: parent
+        columns: 2
+        visible: image.status !== Image.Ready
 
+        Repeater {
+            model: 4
+            Controls.Label{
+                width: icon.width / 2
+                height: icon.height / 2
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+                text: icon.title.charAt(index)
+                color: "White"
+                font.pixelSize: 40
+                font.capitalization: Font.AllUppercase
+                font.family: "Noto Serif"
+                font.bold: true
+                enabled: false
+            }
         }
-
     }
     Image {
-        id:image4
-        anchors.bottom: parent.bottom
-        anchors.right: parent.right
-        width: parent.width/2
-        height: parent.height/2
+        id: image
+        anchors.fill: parent
+        source: coverSource.cachedPath
         fillMode: Image.PreserveAspectCrop
         asynchronous: true
         sourceSize.width: parent.implicitWidth * Screen.devicePixelRatio
-        Controls.Label{
-            z:-1
-            text: icon.title.charAt(3)
-            anchors.centerIn: parent
-            color: "White"
-            font.pixelSize: 40
-            font.capitalization: Font.AllUppercase
-            font.family: "Noto Serif"
-            font.bold: true
-            enabled: false
-
-        }
     }
 
-
-
     Rectangle {
         id: mask
         anchors.fill: parent
         visible: false
     }
 }
-
@@ -20,9 +20,10 @@ Kirigami.PromptDialog {
         Controls.TextField {
             id: urlField
 
-            Kirigami.FormData.label: i18n("Playlist URL (Youtube)")
+            Kirigami.FormData.label: i18n("Playlist URLs (Youtube)")
+            placeholderText: i18n("Separate multiple URLs with spaces")
         }
     }
 
-    onAccepted: model.importPlaylist(urlField.text)
+    onAccepted: model.importPlaylists(urlField.text.split(/\s+/).filter(url => url.length > 0))
 }
@@ -214,6 +214,7 @@ Kirigami.ApplicationWindow {
                     ThumbnailSource {
                         id: thumbnailSource
                         videoId: mpdelegateItem.videoId
+                        size: 70
                     }
                     RoundedImage {
                         source: thumbnailSource.cachedPath
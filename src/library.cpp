@@ -8,11 +8,53 @@
 #include <QDir>
 #include <QStringBuilder>
 #include <QGuiApplication>
+#include <QDebug>
 
 #include <ThreadedDatabase>
 
+#include "libraryqueries.h"
+
 namespace ranges = std::ranges;
 
+using namespace std::chrono_literals;
+
+// Writes happening within this time are committed in one transaction
+constexpr auto WRITE_BATCH_WINDOW = 50ms;
+
+namespace {
+
+///
+/// Turns user input into a full text query that matches rows containing words starting with each of the typed words.
+/// Every word is quoted, so characters in it can't be interpreted as query syntax.
+///
+QString fullTextPrefixQuery(const QString &input)
+{
+    QStringList terms;
+    const auto words = input.simplified().split(u' ', Qt::SkipEmptyParts);
+    for (QString word : words) {
+        terms.append(u'"' % word.replace(u'"', QStringLiteral("\"\"")) % u"\"*");
+    }
+    return terms.join(u' ');
+}
+
+///
+/// Calls the function once the write is committed.
+/// The write batcher cancels the writes of a batch that was rolled back, which the library must not show.
+///
+template <typename Func>
+void whenWritten(QFuture<void> &&written, QObject *context, Func &&func)
+{
+    QCoro::connect(QFuture(written), context, [written, func = std::forward<Func>(func)]() mutable {
+        if (written.isCanceled()) {
+            qWarning() << "Failed to write to the library, the change is not shown";
+            return;
+        }
+        func();
+    });
+}
+
+}
+
 Library::Library(QObject *parent)
     : QObject{parent}
     , m_database(ThreadedDatabase::establishConnection([]() -> DatabaseConfiguration {
@@ -27,10 +69,19 @@ Library::Library(QObject *parent)
     }()))
 {
     m_database->runMigrations(":/migrations/");
+    for (const char *trigger : queries::FULL_TEXT_TRIGGERS) {
+        m_database->execute(QString::fromLatin1(trigger));
+    }
+    m_statements = std::make_unique<StatementCache>(*m_database);
+    m_writes = new WriteBatcher(*m_statements, WRITE_BATCH_WINDOW, this);
     m_searches = new SearchHistoryModel(this);
+    m_favourites = new FavouritesModel(this);
+    m_playbackHistory = new PlaybackHistoryModel(this);
+    m_mostPlayed = new PlaybackHistoryModel(this);
 
     refreshFavourites();
     refreshPlaybackHistory();
+    loadMemberships();
 }
 
 Library::~Library() = default;
@@ -48,16 +99,21 @@ FavouritesModel *Library::favourites()
 
 void Library::addFavourite(const QString &videoId, const QString &title, const QString &artist, const QString &album)
 {
-    QCoro::connect(addSong(videoId, title, artist, album), this, [=, this] {
-        QCoro::connect(m_database->execute("insert or ignore into favourites (video_id) values (?)", videoId),
-                       this, &Library::refreshFavourites);
+    addSong(videoId, title, artist, album);
+    whenWritten(m_writes->execute(queries::ADD_FAVOURITE, videoId), this, [=, this] {
+        m_favourites->prependSong(Song { videoId, title, artist, album });
+        setFavourite(videoId, true);
+        Q_EMIT favouritesChanged();
     });
 }
 
 void Library::removeFavourite(const QString &videoId)
 {
-    QCoro::connect(m_database->execute("delete from favourites where video_id = ?", videoId),
-                   this, &Library::refreshFavourites);
+    whenWritten(m_writes->execute(queries::REMOVE_FAVOURITE, videoId), this, [=, this] {
+        m_favourites->removeSong(videoId);
+        setFavourite(videoId, false);
+        Q_EMIT favouritesChanged();
+    });
 }
 
 FavouriteWatcher *Library::favouriteWatcher(const QString &videoId)
@@ -65,7 +121,44 @@ FavouriteWatcher *Library::favouriteWatcher(const QString &videoId)
     if (videoId.isEmpty()) {
         return nullptr;
     }
-    return new FavouriteWatcher(this, videoId);
+
+    auto &watcher = m_favouriteWatchers[videoId];
+    if (!watcher) {
+        watcher = new FavouriteWatcher(this, videoId);
+    }
+    return watcher;
+}
+
+bool Library::isFavourite(const QString &videoId) const
+{
+    return m_favouriteIds.contains(videoId);
+}
+
+void Library::setFavourite(const QString &videoId, bool favourite)
+{
+    if (favourite) {
+        m_favouriteIds.insert(videoId);
+    } else {
+        m_favouriteIds.remove(videoId);
+    }
+
+    if (auto *watcher = m_favouriteWatchers.value(videoId)) {
+        watcher->setFavourite(favourite);
+    }
+}
+
+void Library::loadMemberships()
+{
+    QCoro::connect(m_statements->getResults<SingleValue<QString>>(queries::FAVOURITE_IDS), this, [this](auto ids) {
+        for (const auto &id : ids) {
+            setFavourite(id.value, true);
+        }
+    });
+    QCoro::connect(m_statements->getResults<SingleValue<QString>>(queries::PLAYED_IDS), this, [this](auto ids) {
+        for (const auto &id : ids) {
+            setPlayed(id.value, true);
+        }
+    });
 }
 
 SearchHistoryModel *Library::searches()
@@ -76,12 +169,12 @@ SearchHistoryModel *Library::searches()
 void Library::addSearch(const QString &text)
 {
     m_searches->addSearch(text);
-    QCoro::connect(m_database->execute("insert into searches (search_query) values (?)", text), this, &Library::searchesChanged);
+    QCoro::connect(m_statements->execute(queries::ADD_SEARCH, text), this, &Library::searchesChanged);
 }
 
 void Library::removeSearch(const QString &text) {
     m_searches->removeSearch(text);
-    QCoro::connect(m_database->execute("delete from searches where search_query = ?", text), this, &Library::searchesChanged);
+    QCoro::connect(m_statements->execute(queries::REMOVE_SEARCH, text), this, &Library::searchesChanged);
 }
 
 const QString& Library::temporarySearch()
@@ -104,38 +197,60 @@ PlaybackHistoryModel *Library::playbackHistory()
 void Library::refreshPlaybackHistory()
 {
     // playbackHistory
-    auto future = m_database->getResults<PlayedSong>(
-        "select * from played_songs natural join songs");
-    m_playbackHistory = new PlaybackHistoryModel(std::move(future), this);
+    auto future = m_statements->getResults<PlayedSong>(queries::PLAYBACK_HISTORY);
+    QCoro::connect(std::move(future), this, [this](auto songs) {
+        m_playbackHistory->setSongs(std::move(songs));
+        Q_EMIT playbackHistoryChanged();
+    });
 
-    // mostPlayed
-    auto future2 = m_database->getResults<PlayedSong>(
-        "select * from played_songs natural join songs order by plays desc limit 10");
-    m_mostPlayed = new PlaybackHistoryModel(std::move(future2), this);
-    Q_EMIT playbackHistoryChanged();
+    refreshMostPlayed();
+}
+
+void Library::refreshMostPlayed()
+{
+    auto future = m_statements->getResults<PlayedSong>(queries::MOST_PLAYED);
+    QCoro::connect(std::move(future), this, [this](auto songs) {
+        m_mostPlayed->setSongs(std::move(songs));
+    });
 }
 
 void Library::refreshFavourites()
 {
-    auto future = m_database->getResults<Song>(
-        "select * from favourites natural join songs order by favourites.rowid desc");
-    m_favourites = new FavouritesModel(std::move(future), this);
-    Q_EMIT favouritesChanged();
+    auto future = m_statements->getResults<Song>(queries::FAVOURITES);
+    QCoro::connect(std::move(future), this, [this](auto songs) {
+        m_favourites->setSongs(std::move(songs));
+        Q_EMIT favouritesChanged();
+    });
 }
 
 void Library::addPlaybackHistoryItem(const QString &videoId, const QString &title, const QString &artist, const QString &album)
 {
-    QCoro::connect(addSong(videoId, title, artist, album), this, [=, this] {
-        QCoro::connect(m_database->execute("insert or ignore into played_songs (video_id, plays) values (?, ?)", videoId, 0), this, [=, this] {
-            QCoro::connect(m_database->execute("update played_songs set plays = plays + 1 where video_id = ? ", videoId),
-                           this, &Library::refreshPlaybackHistory);
+    addSong(videoId, title, artist, album);
+    auto written = m_writes->execute(queries::ADD_PLAY, videoId);
+
+    // Only the played song and the most played list can have changed
+    whenWritten(std::move(written), this, [=, this] {
+        setPlayed(videoId, true);
+
+        auto future = m_statements->getResult<PlayedSong>(queries::PLAYED_SONG, videoId);
+        QCoro::connect(std::move(future), this, [this](auto song) {
+            if (song) {
+                m_playbackHistory->updateSong(std::move(*song));
+            }
+            refreshMostPlayed();
+            Q_EMIT playbackHistoryChanged();
         });
     });
 }
+
 void Library::removePlaybackHistoryItem(const QString &videoId)
 {
-    QCoro::connect(m_database->execute("delete from played_songs where video_id = ?", videoId),
-                   this, &Library::refreshPlaybackHistory);
+    whenWritten(m_writes->execute(queries::REMOVE_PLAYED, videoId), this, [=, this] {
+        m_playbackHistory->removeSong(videoId);
+        setPlayed(videoId, false);
+        refreshMostPlayed();
+        Q_EMIT playbackHistoryChanged();
+    });
 }
 
 WasPlayedWatcher *Library::wasPlayedWatcher(const QString& videoId)
@@ -143,7 +258,30 @@ WasPlayedWatcher *Library::wasPlayedWatcher(const QString& videoId)
     if(videoId.isEmpty()){
         return nullptr;
     }
-    return new WasPlayedWatcher(this, videoId);
+
+    auto &watcher = m_wasPlayedWatchers[videoId];
+    if (!watcher) {
+        watcher = new WasPlayedWatcher(this, videoId);
+    }
+    return watcher;
+}
+
+bool Library::wasPlayed(const QString &videoId) const
+{
+    return m_playedIds.contains(videoId);
+}
+
+void Library::setPlayed(const QString &videoId, bool played)
+{
+    if (played) {
+        m_playedIds.insert(videoId);
+    } else {
+        m_playedIds.remove(videoId);
+    }
+
+    if (auto *watcher = m_wasPlayedWatchers.value(videoId)) {
+        watcher->setWasPlayed(played);
+    }
 }
 
 
@@ -161,22 +299,18 @@ QNetworkAccessManager &Library::nam()
 
 QFuture<void> Library::addSong(const QString &videoId, const QString &title, const QString &artist, const QString &album)
 {
-    // replace is used here to update songs from times when we didn't store artist and album
-    return m_database->execute("insert or replace into songs (video_id, title, artist, album) values (?, ?, ?, ?)", videoId, title, artist, album);
+    return m_writes->execute(queries::ADD_SONG, videoId, title, artist, album);
 }
 
-PlaybackHistoryModel::PlaybackHistoryModel(QFuture<std::vector<PlayedSong>> &&songs, QObject *parent)
-    : QAbstractListModel(parent)
+QFuture<void> Library::addPlaylistEntries(qint64 playlistId, const std::vector<Song> &songs)
 {
-    QCoro::connect(std::move(songs), this, [this](const auto songs) {
-        beginResetModel();
-        m_playedSongs = songs;
-        endResetModel();
-    });
+    // Keep the order of writes that are still waiting in the batch
+    m_writes->flush();
+    return m_statements->executeInTransaction(queries::addPlaylistEntries(playlistId, songs));
 }
 
 PlaybackHistoryModel::PlaybackHistoryModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : KeyedListModel<QAbstractListModel>(parent)
 {
 }
 
@@ -221,15 +355,49 @@ std::vector<PlayedSong> PlaybackHistoryModel::getPlayedSong() const
     return m_playedSongs;
 }
 
+void PlaybackHistoryModel::setSongs(std::vector<PlayedSong> &&songs)
+{
+    updateRows(m_playedSongs, std::move(songs), &PlayedSong::videoId);
+}
 
-FavouritesModel::FavouritesModel(QFuture<std::vector<Song>> &&songs, QObject *parent)
-    : QAbstractListModel(parent)
+void PlaybackHistoryModel::updateSong(PlayedSong &&song)
+{
+    // The history is ordered by the time a song was last played, so the song moves to the top
+    auto it = ranges::find(m_playedSongs, song.videoId, &PlayedSong::videoId);
+    if (it != m_playedSongs.end()) {
+        const int row = int(std::distance(m_playedSongs.begin(), it));
+        if (row != 0) {
+            beginMoveRows({}, row, row, {}, 0);
+            std::rotate(m_playedSongs.begin(), it, it + 1);
+            endMoveRows();
+        }
+        m_playedSongs.front() = std::move(song);
+        Q_EMIT dataChanged(index(0), index(0));
+        return;
+    }
+
+    beginInsertRows({}, 0, 0);
+    m_playedSongs.insert(m_playedSongs.begin(), std::move(song));
+    endInsertRows();
+}
+
+void PlaybackHistoryModel::removeSong(const QString &videoId)
+{
+    auto it = ranges::find(m_playedSongs, videoId, &PlayedSong::videoId);
+    if (it == m_playedSongs.end()) {
+        return;
+    }
+
+    const int row = int(std::distance(m_playedSongs.begin(), it));
+    beginRemoveRows({}, row, row);
+    m_playedSongs.erase(it);
+    endRemoveRows();
+}
+
+
+FavouritesModel::FavouritesModel(QObject *parent)
+    : KeyedListModel<QAbstractListModel>(parent)
 {
-    QCoro::connect(std::move(songs), this, [this](const auto songs) {
-        beginResetModel();
-        m_favouriteSongs = songs;
-        endResetModel();
-    });
 }
 
 QHash<int, QByteArray> FavouritesModel::roleNames() const {
@@ -269,36 +437,62 @@ std::vector<Song> FavouritesModel::getFavouriteSongs() const {
     return m_favouriteSongs;
 }
 
+void FavouritesModel::setSongs(std::vector<Song> &&songs)
+{
+    updateRows(m_favouriteSongs, std::move(songs), &Song::videoId);
+}
+
+void FavouritesModel::prependSong(Song &&song)
+{
+    if (ranges::find(m_favouriteSongs, song.videoId, &Song::videoId) != m_favouriteSongs.end()) {
+        return;
+    }
+
+    beginInsertRows({}, 0, 0);
+    m_favouriteSongs.insert(m_favouriteSongs.begin(), std::move(song));
+    endInsertRows();
+}
+
+void FavouritesModel::removeSong(const QString &videoId)
+{
+    auto it = ranges::find(m_favouriteSongs, videoId, &Song::videoId);
+    if (it == m_favouriteSongs.end()) {
+        return;
+    }
+
+    const int row = int(std::distance(m_favouriteSongs.begin(), it));
+    beginRemoveRows({}, row, row);
+    m_favouriteSongs.erase(it);
+    endRemoveRows();
+}
+
 FavouriteWatcher::FavouriteWatcher(Library *library, const QString &videoId)
-    : QObject(library), m_videoId(videoId), m_library(library)
+    : QObject(library), m_videoId(videoId), m_isFavourite(library->isFavourite(videoId))
 {
-    auto update = [this] {
-        QCoro::connect(m_library->database().getResult<SingleValue<bool>>("select count(*) > 0 from favourites where video_id = ?", m_videoId), this, [this](auto count) {
-            if (count) {
-                m_isFavourite = count->value;
-                Q_EMIT isFavouriteChanged();
-            }
-        });
-    };
-    update();
-    connect(library, &Library::favouritesChanged, this, update);
 }
 
 bool FavouriteWatcher::isFavourite() const {
     return m_isFavourite;
 }
 
+void FavouriteWatcher::setFavourite(bool favourite)
+{
+    if (m_isFavourite != favourite) {
+        m_isFavourite = favourite;
+        Q_EMIT isFavouriteChanged();
+    }
+}
+
 SearchHistoryModel::SearchHistoryModel(Library *library)
     : QAbstractListModel(library)
 {
-    auto historyFuture = library->database()
-                            .getResults<SingleValue<QString>>("select distinct (search_query) from searches order by search_id desc limit 20");
+    auto historyFuture = library->statements().getResults<SingleValue<QString>>(queries::SEARCH_HISTORY);
 
     connect(this, &SearchHistoryModel::filterChanged, this, [library, this]() {
-        auto future = library->database()
-            .getResults<SingleValue<QString>>("select distinct (search_query) from searches "
-                                              "where search_query like '%" % m_filter % "%'"
-                                              "order by search_id desc limit 20");
+        const auto query = fullTextPrefixQuery(m_filter);
+        auto future = query.isEmpty()
+            ? library->statements().getResults<SingleValue<QString>>(queries::SEARCH_HISTORY)
+            : library->statements().getResults<SingleValue<QString>>(queries::SEARCH_HISTORY_MATCHING, query);
 
         QCoro::connect(std::move(future), this, [this](auto history) {
             beginResetModel();
@@ -409,15 +603,8 @@ void SearchHistoryModel::setTemporarySearch(const QString& text)
 
 
 WasPlayedWatcher::WasPlayedWatcher(Library* library, const QString& videoId)
-    : QObject(library), m_videoId(videoId), m_library(library)
-{
-    connect(m_library, &Library::playbackHistoryChanged, this, &WasPlayedWatcher::query);
-    query();
-}
-
-void WasPlayedWatcher::query()
+    : QObject(library), m_wasPlayed(library->wasPlayed(videoId)), m_videoId(videoId)
 {
-    QCoro::connect(m_library->database().getResult<SingleValue<bool>>("select count(*) > 0 from played_songs where video_id = ?", m_videoId), this, &WasPlayedWatcher::update);
 }
 
 
@@ -427,11 +614,10 @@ bool WasPlayedWatcher::wasPlayed() const
 }
 
 
-void WasPlayedWatcher::update(std::optional<SingleValue<bool> > result)
+void WasPlayedWatcher::setWasPlayed(bool wasPlayed)
 {
-    if(result.has_value())
-    {
-        m_wasPlayed = result->value;
+    if (m_wasPlayed != wasPlayed) {
+        m_wasPlayed = wasPlayed;
         Q_EMIT wasPlayedChanged();
     }
 }
@@ -439,14 +625,12 @@ void WasPlayedWatcher::update(std::optional<SingleValue<bool> > result)
 LocalSearchModel::LocalSearchModel(QObject *parent) : PlaybackHistoryModel(parent)
 {
     connect(this, &LocalSearchModel::searchQueryChanged, this, [this]() {
-        auto resultFuture = Library::instance().database()
-                                .getResults<PlayedSong>("select * from played_songs natural join songs "
-                                                        "where title like '%" % m_searchQuery % "%' "
-                                                        "order by plays desc limit 10");
+        const auto query = fullTextPrefixQuery(m_searchQuery);
+        auto resultFuture = query.isEmpty()
+            ? Library::instance().statements().getResults<PlayedSong>(queries::MOST_PLAYED)
+            : Library::instance().statements().getResults<PlayedSong>(queries::SEARCH_PLAYED, query);
         QCoro::connect(std::move(resultFuture), this, [this](auto results) {
-               beginResetModel();
-               m_playedSongs = results;
-               endResetModel();
-           });
+            setSongs(std::move(results));
+        });
     });
 }
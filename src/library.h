@@ -9,12 +9,17 @@
 #include <QNetworkAccessManager>
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
+#include <QHash>
+#include <QSet>
 
 #include <ThreadedDatabase>
 
 #include <memory>
 
 #include "asyncytmusic.h"
+#include "modeldiff.h"
+#include "statementcache.h"
+#include "writebatcher.h"
 
 class FavouriteWatcher;
 class WasPlayedWatcher;
@@ -27,13 +32,15 @@ struct Song {
         return Song {videoId, title, artist, album};
     }
 
+    bool operator==(const Song &other) const = default;
+
     QString videoId;
     QString title;
     QString artist;
     QString album;
 };
 
-class FavouritesModel : public QAbstractListModel {
+class FavouritesModel : public KeyedListModel<QAbstractListModel> {
     Q_OBJECT
 
     enum Roles {
@@ -44,13 +51,19 @@ class FavouritesModel : public QAbstractListModel {
     };
 
 public:
-    FavouritesModel(QFuture<std::vector<Song>> &&songs, QObject *parent = nullptr);
+    FavouritesModel(QObject *parent = nullptr);
 
     QHash<int, QByteArray> roleNames() const override;
     int rowCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
     std::vector<Song> getFavouriteSongs() const;
 
+    /// Updates the model to contain songs, only emitting changes for rows that differ
+    void setSongs(std::vector<Song> &&songs);
+    /// Adds the song at the top, if it is not in the model yet
+    void prependSong(Song &&song);
+    void removeSong(const QString &videoId);
+
 private:
     std::vector<Song> m_favouriteSongs;
 };
@@ -63,6 +76,8 @@ struct PlayedSong {
         return PlayedSong {videoId, title, artist, album, plays};
     }
 
+    bool operator==(const PlayedSong &other) const = default;
+
     QString videoId;
     QString title;
     QString artist;
@@ -70,7 +85,7 @@ struct PlayedSong {
     int plays;
 };
 
-class PlaybackHistoryModel : public QAbstractListModel {
+class PlaybackHistoryModel : public KeyedListModel<QAbstractListModel> {
     Q_OBJECT
 
 public:
@@ -83,7 +98,6 @@ public:
     };
     Q_ENUM(Roles);
 
-    PlaybackHistoryModel(QFuture<std::vector<PlayedSong>> &&songs, QObject *parent = nullptr);
     PlaybackHistoryModel(QObject *parent = nullptr);
 
     QHash<int, QByteArray> roleNames() const override;
@@ -91,6 +105,12 @@ public:
     QVariant data(const QModelIndex &index, int role) const override;
     std::vector<PlayedSong> getPlayedSong() const;
 
+    /// Updates the model to contain songs, only emitting changes for rows that differ
+    void setSongs(std::vector<PlayedSong> &&songs);
+    /// Moves the song to the top and updates its row, or inserts it if it is not in the model yet
+    void updateSong(PlayedSong &&song);
+    void removeSong(const QString &videoId);
+
 protected:
     std::vector<PlayedSong> m_playedSongs;
 };
@@ -158,6 +178,7 @@ public:
     Q_INVOKABLE void addFavourite(const QString &videoId, const QString &title, const QString &artist, const QString &album);
     Q_INVOKABLE void removeFavourite(const QString &videoId);
     Q_INVOKABLE FavouriteWatcher *favouriteWatcher(const QString &videoId);
+    bool isFavourite(const QString &videoId) const;
 
     SearchHistoryModel *searches();
     Q_SIGNAL void searchesChanged();
@@ -173,6 +194,7 @@ public:
     Q_INVOKABLE void addPlaybackHistoryItem(const QString &videoId, const QString &title, const QString &artist, const QString &album);
     Q_INVOKABLE void removePlaybackHistoryItem(const QString &videoId);
     Q_INVOKABLE WasPlayedWatcher *wasPlayedWatcher(const QString &videoId);
+    bool wasPlayed(const QString &videoId) const;
 
     Q_SIGNAL void playlistsChanged();
 
@@ -182,16 +204,37 @@ public:
     ThreadedDatabase &database() {
         return *m_database;
     }
+    /// Prefer this over database() for queries that run repeatedly
+    StatementCache &statements() {
+        return *m_statements;
+    }
     QFuture<void> addSong(const QString &videoId, const QString &title, const QString &artist, const QString &album);
+    /// Adds all songs to the end of a playlist in one transaction, using one insert statement for many rows.
+    /// The progress value of the returned future counts the executed statements, not the songs.
+    QFuture<void> addPlaylistEntries(qint64 playlistId, const std::vector<Song> &songs);
 
 private:
+    void refreshMostPlayed();
+    void loadMemberships();
+    void setFavourite(const QString &videoId, bool favourite);
+    void setPlayed(const QString &videoId, bool played);
 
     QNetworkAccessManager m_networkImageCacher;
     std::unique_ptr<ThreadedDatabase> m_database;
+    // Destroyed before the database, as it finalizes its statements on the database thread
+    std::unique_ptr<StatementCache> m_statements;
+    WriteBatcher *m_writes;
     SearchHistoryModel *m_searches;
     FavouritesModel *m_favourites;
     PlaybackHistoryModel *m_mostPlayed;
     PlaybackHistoryModel *m_playbackHistory;
+
+    // Ids of all favourite and played songs, so watchers don't need to query the database
+    QSet<QString> m_favouriteIds;
+    QSet<QString> m_playedIds;
+    // One watcher per song, which is notified directly when the membership of its song changes
+    QHash<QString, FavouriteWatcher *> m_favouriteWatchers;
+    QHash<QString, WasPlayedWatcher *> m_wasPlayedWatchers;
 };
 
 class FavouriteWatcher : public QObject {
@@ -208,8 +251,10 @@ public:
     Q_SIGNAL void videoIdChanged();
 
 private:
+    friend class Library;
+    void setFavourite(bool favourite);
+
     QString m_videoId;
-    Library *m_library;
     bool m_isFavourite = false;
 };
 
@@ -226,9 +271,9 @@ public:
     Q_SIGNAL void wasPlayedChanged();
 
 private:
+    friend class Library;
+    void setWasPlayed(bool wasPlayed);
+
     bool m_wasPlayed = false;
     QString m_videoId;
-    Library *m_library;
-    Q_SLOT void update(std::optional<SingleValue<bool> > result);
-    Q_SLOT void query();
 };
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QString>
+#include <QStringBuilder>
+#include <QStringList>
+#include <QVariant>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+///
+/// The statements Library runs on the library database.
+/// They are collected here, so the benchmarks time exactly the queries the application uses.
+///
+namespace queries {
+
+// Keep the full text indexes created by the full_text_search migration in sync.
+// They are created by Library, because the migration runner splits statements at semicolons.
+constexpr std::array FULL_TEXT_TRIGGERS = {
+    "create trigger if not exists songs_fts_insert after insert on songs begin "
+        "insert into songs_fts (rowid, title, artist, album) values (new.rowid, new.title, new.artist, new.album); "
+    "end",
+    "create trigger if not exists songs_fts_delete after delete on songs begin "
+        "insert into songs_fts (songs_fts, rowid, title, artist, album) values ('delete', old.rowid, old.title, old.artist, old.album); "
+    "end",
+    "create trigger if not exists songs_fts_update after update on songs begin "
+        "insert into songs_fts (songs_fts, rowid, title, artist, album) values ('delete', old.rowid, old.title, old.artist, old.album); "
+        "insert into songs_fts (rowid, title, artist, album) values (new.rowid, new.title, new.artist, new.album); "
+    "end",
+    "create trigger if not exists searches_fts_insert after insert on searches begin "
+        "insert into searches_fts (rowid, search_query) values (new.search_id, new.search_query); "
+    "end",
+    "create trigger if not exists searches_fts_delete after delete on searches begin "
+        "insert into searches_fts (searches_fts, rowid, search_query) values ('delete', old.search_id, old.search_query); "
+    "end",
+};
+
+// Songs
+
+// The update is used here to update songs from times when we didn't store artist and album.
+// Unlike replace, it keeps the rowid, and runs the update trigger of the full text index.
+constexpr auto ADD_SONG = "insert into songs (video_id, title, artist, album) values (?, ?, ?, ?) "
+                          "on conflict (video_id) do update set title = excluded.title, artist = excluded.artist, album = excluded.album";
+
+// Favourites
+
+constexpr auto FAVOURITE_IDS = "select video_id from favourites";
+constexpr auto FAVOURITES = "select video_id, title, artist, album from favourites natural join songs "
+                            "order by favourites.rowid desc";
+constexpr auto ADD_FAVOURITE = "insert or ignore into favourites (video_id) values (?)";
+constexpr auto REMOVE_FAVOURITE = "delete from favourites where video_id = ?";
+
+// Playback history
+
+constexpr auto PLAYED_IDS = "select video_id from played_songs";
+constexpr auto PLAYBACK_HISTORY = "select video_id, plays, title, artist, album from played_songs natural join songs "
+                                  "order by last_played desc";
+constexpr auto MOST_PLAYED = "select video_id, plays, title, artist, album from played_songs natural join songs "
+                             "order by plays desc limit 10";
+constexpr auto PLAYED_SONG = "select video_id, plays, title, artist, album from played_songs natural join songs "
+                             "where video_id = ?";
+constexpr auto ADD_PLAY = "insert into played_songs (video_id, plays, last_played) values (?, 1, current_timestamp) "
+                          "on conflict (video_id) do update set plays = plays + 1, last_played = current_timestamp";
+constexpr auto REMOVE_PLAYED = "delete from played_songs where video_id = ?";
+constexpr auto SEARCH_PLAYED = "select songs.video_id, played_songs.plays, songs.title, songs.artist, songs.album "
+                               "from songs_fts "
+                               "join songs on songs.rowid = songs_fts.rowid "
+                               "join played_songs on played_songs.video_id = songs.video_id "
+                               "where songs_fts match ? "
+                               "order by songs_fts.rank, played_songs.plays desc limit 10";
+
+// Search history
+
+constexpr auto SEARCH_HISTORY = "select distinct (search_query) from searches order by search_id desc limit 20";
+constexpr auto SEARCH_HISTORY_MATCHING = "select search_query from ("
+                                         "select searches.search_query, searches.search_id, searches_fts.rank from searches_fts "
+                                         "join searches on searches.search_id = searches_fts.rowid "
+                                         "where searches_fts match ?) "
+                                         "group by search_query order by min(rank), max(search_id) desc limit 20";
+constexpr auto ADD_SEARCH = "insert into searches (search_query) values (?)";
+constexpr auto REMOVE_SEARCH = "delete from searches where search_query = ?";
+
+// Playlists
+
+// Rows per insert statement when adding many songs at once. Stays below SQLite's limit of 999 bound parameters.
+constexpr size_t BULK_INSERT_ROWS = 100;
+
+/// Repeats the parenthesized placeholders of one row, like "(?, ?), (?, ?)"
+inline QString valuesPlaceholders(QStringView row, size_t rows)
+{
+    QStringList placeholders;
+    placeholders.reserve(qsizetype(rows));
+    for (size_t i = 0; i < rows; i++) {
+        placeholders.append(row.toString());
+    }
+    return placeholders.join(u", ");
+}
+
+/// Statements that add the songs and add them to the playlist, with many rows in each insert.
+/// Songs can be any type with the members of Song.
+template <typename Songs>
+std::vector<std::pair<QString, QVariantList>> addPlaylistEntries(qint64 playlistId, const Songs &songs)
+{
+    std::vector<std::pair<QString, QVariantList>> statements;
+
+    for (size_t first = 0; first < songs.size(); first += BULK_INSERT_ROWS) {
+        const size_t rows = std::min(BULK_INSERT_ROWS, songs.size() - first);
+
+        QVariantList songValues;
+        QVariantList entryValues;
+        songValues.reserve(qsizetype(rows * 4));
+        entryValues.reserve(qsizetype(rows * 2));
+        for (size_t i = first; i < first + rows; i++) {
+            const auto &song = songs[i];
+            songValues << song.videoId << song.title << song.artist << song.album;
+            entryValues << playlistId << song.videoId;
+        }
+
+        // Same as ADD_SONG, for many songs at once
+        statements.emplace_back(u"insert into songs (video_id, title, artist, album) values " % valuesPlaceholders(u"(?, ?, ?, ?)", rows)
+                                    % u" on conflict (video_id) do update set title = excluded.title, artist = excluded.artist, album = excluded.album",
+                                std::move(songValues));
+        // A song can only be in a playlist once, but imported playlists can contain it more than once
+        statements.emplace_back(u"insert or ignore into playlist_entries (playlist_id, video_id) values " % valuesPlaceholders(u"(?, ?)", rows),
+                                std::move(entryValues));
+    }
+
+    return statements;
+}
+
+}
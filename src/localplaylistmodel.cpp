@@ -7,12 +7,10 @@
 #include "library.h"
 
 LocalPlaylistModel::LocalPlaylistModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : KeyedListModel<QAbstractListModel>(parent)
 {
     connect(this, &LocalPlaylistModel::playlistIdChanged,
             this, &LocalPlaylistModel::refreshModel);
-    connect(this, &LocalPlaylistModel::playlistIdChanged,
-            this, &LocalPlaylistModel::refreshModel);
 }
 
 int LocalPlaylistModel::rowCount(const QModelIndex &index) const
@@ -66,15 +64,13 @@ void LocalPlaylistModel::setPlaylistId(const QString &playlistId)
 void LocalPlaylistModel::refreshModel()
 {
     auto future = Library::instance()
-            .database()
+            .statements()
             .getResults<PlaylistEntry>(
                 "select video_id, title, artist, album from "
                 "playlist_entries natural join songs where playlist_id = ?", m_playlistId);
 
     QCoro::connect(std::move(future), this, [this](auto entries) {
-        beginResetModel();
-        m_entries = entries;
-        endResetModel();
+        updateRows(m_entries, std::move(entries), &PlaylistEntry::videoId);
     });
 }
 
@@ -85,5 +81,9 @@ const std::vector<PlaylistEntry> &LocalPlaylistModel::entries() const
 
 void LocalPlaylistModel::removeSong(QString videoId, qint64 playlistId)
 {
-    QCoro::connect(Library::instance().database().execute("delete from playlist_entries where playlist_id = ? and video_id = ?", playlistId, videoId), this, &LocalPlaylistModel::refreshModel);
+    QCoro::connect(Library::instance().statements().execute("delete from playlist_entries where playlist_id = ? and video_id = ?", playlistId, videoId), this, [this] {
+        refreshModel();
+        // Updates the cover of the playlist
+        Q_EMIT Library::instance().playlistsChanged();
+    });
 }
@@ -8,6 +8,8 @@
 
 #include <vector>
 
+#include "modeldiff.h"
+
 struct PlaylistEntry {
     using ColumnTypes = std::tuple<QString, QString, QString, QString>;
 
@@ -16,13 +18,15 @@ struct PlaylistEntry {
         return PlaylistEntry { videoId, title, artists, album };
     }
 
+    bool operator==(const PlaylistEntry &other) const = default;
+
     QString videoId;
     QString title;
     QString artists;
     QString album;
 };
 
-class LocalPlaylistModel : public QAbstractListModel
+class LocalPlaylistModel : public KeyedListModel<QAbstractListModel>
 {
     Q_OBJECT
     Q_PROPERTY(QString playlistId READ playlistId WRITE setPlaylistId NOTIFY playlistIdChanged)
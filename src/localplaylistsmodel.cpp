@@ -13,15 +13,16 @@
 
 #include <KLocalizedString>
 
-Q_DECLARE_METATYPE(std::vector<QString>);
-
 LocalPlaylistsModel::LocalPlaylistsModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : KeyedListModel<QAbstractListModel>(parent)
 {
     importer = new PlaylistImporter(this);
     connect(importer, &PlaylistImporter::playlistEntriesChanged, this, &LocalPlaylistsModel::playlistEntriesChanged);
     connect(importer,&PlaylistImporter::importFinished, this, &LocalPlaylistsModel::importFinished);
+    connect(importer, &PlaylistImporter::importProgress, this, &LocalPlaylistsModel::importProgress);
     connect(importer, &PlaylistImporter::refreshModel, this, &LocalPlaylistsModel::refreshModel);
+    // The songs on the covers may have changed
+    connect(importer, &PlaylistImporter::playlistEntriesChanged, this, &LocalPlaylistsModel::refreshModel);
     connect(&Library::instance(), &Library::playlistsChanged,
             this, &LocalPlaylistsModel::refreshModel);
     refreshModel();
@@ -55,7 +56,7 @@ QVariant LocalPlaylistsModel::data(const QModelIndex &index, int role) const
     case Roles::CreatedOn:
         return m_playlists[index.row()].createdOn;
     case Roles::ThumbnailIds:
-        return QVariant::fromValue(m_thumbnailIds.at(index.row()));
+        return m_playlists.at(index.row()).thumbnailIds;
     }
 
     Q_UNREACHABLE();
@@ -63,19 +64,20 @@ QVariant LocalPlaylistsModel::data(const QModelIndex &index, int role) const
 
 void LocalPlaylistsModel::refreshModel()
 {
-    QCoro::connect(Library::instance().database().getResults<Playlist>("select * from playlists"), this, [this](const auto &&playlists) {
-        m_thumbnailIds.resize(playlists.size());
-        for (size_t i = 0; i < playlists.size(); i++) {
-            auto future = Library::instance().database().getResults<SingleValue<QString>>("select video_id from playlist_entries where playlist_id = ? order by random() limit 4", playlists.at(i).playlistId);
-            QCoro::connect(std::move(future), this, [this, playlists, i](auto &&ids) {
-                std::ranges::transform(ids, std::back_inserter(m_thumbnailIds[i]), [](auto &&id) { return id.value; });
-                dataChanged(index(i), index(i), {Roles::ThumbnailIds});
-            });
-        }
-
-        beginResetModel();
-        m_playlists = playlists;
-        endResetModel();
+    // Loads the playlists together with the first four songs of each, which are shown on the cover.
+    // The songs are numbered in primary key order, so this doesn't need to sort the entries.
+    // group_concat only accepts an order by from SQLite 3.44 on, so the rows are sorted in a subquery,
+    // whose order SQLite keeps when it concatenates them.
+    auto future = Library::instance().statements().getResults<Playlist>(
+        "select playlist_id, title, description, created_on, group_concat(video_id) from ("
+            "select playlists.playlist_id, title, description, created_on, covers.video_id from playlists "
+            "left join (select playlist_id, video_id, row_number() over (partition by playlist_id order by video_id) as position "
+                       "from playlist_entries) as covers "
+            "on covers.playlist_id = playlists.playlist_id and covers.position <= 4 "
+            "order by playlists.playlist_id, covers.position) "
+        "group by playlist_id");
+    QCoro::connect(std::move(future), this, [this](auto playlists) {
+        updateRows(m_playlists, std::move(playlists), &Playlist::playlistId);
     });
 }
 void LocalPlaylistsModel::addPlaylist(const QString &title, const QString &description)
@@ -98,6 +100,11 @@ void LocalPlaylistsModel::importPlaylist(const QString &url)
     importer->importPlaylist(url);
 }
 
+void LocalPlaylistsModel::importPlaylists(const QStringList &urls)
+{
+    importer->importPlaylists(urls);
+}
+
 void LocalPlaylistsModel::renamePlaylist(qint64 playlistId, const QString &name, const QString &description)
 {
     importer->renamePlaylist(playlistId, name, description);
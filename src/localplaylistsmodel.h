@@ -6,27 +6,31 @@
 
 #include "ytmusic.h"
 #include "playlistimporter.h"
+#include "modeldiff.h"
 #include <QAbstractListModel>
 #include <QDateTime>
 
 #include <ThreadedDatabase>
 
 struct Playlist {
-    using ColumnTypes = std::tuple<qint64, QString, QString, QDateTime>;
+    using ColumnTypes = std::tuple<qint64, QString, QString, QDateTime, QString>;
 
+    /// The last column contains the comma separated ids of the songs shown on the cover
     Playlist static fromSql(ColumnTypes tuple) {
-        auto [playlistId, title, description, createdOn] = tuple;
-        return Playlist { playlistId, title, description, createdOn };
+        auto [playlistId, title, description, createdOn, thumbnailIds] = tuple;
+        return Playlist { playlistId, title, description, createdOn, thumbnailIds.split(u',', Qt::SkipEmptyParts) };
     }
 
     qint64 playlistId;
     QString title;
     QString description;
     QDateTime createdOn;
+    QStringList thumbnailIds;
 
+    bool operator==(const Playlist &other) const = default;
 };
 
-class LocalPlaylistsModel : public QAbstractListModel
+class LocalPlaylistsModel : public KeyedListModel<QAbstractListModel>
 {
     Q_OBJECT
 
@@ -49,7 +53,9 @@ public:
     Q_INVOKABLE void addPlaylistEntry(qint64 playlistId, const QString &videoId, const QString &title, const QString &artist, const QString &album);
     Q_INVOKABLE void addPlaylistEntry(qint64 playlistId, const playlist::Track &track);
     Q_INVOKABLE void importPlaylist(const QString &url);
+    Q_INVOKABLE void importPlaylists(const QStringList &urls);
     Q_SIGNAL void importFinished();
+    Q_SIGNAL void importProgress(qint64 playlistId, qreal progress);
 
     Q_INVOKABLE void renamePlaylist(qint64 playlistId, const QString &name, const QString &description);
     Q_INVOKABLE void deletePlaylist(qint64 playlistId);
@@ -62,7 +68,6 @@ public:
 private:
     QStringView cropURL(QStringView srcURL);
     std::vector<Playlist> m_playlists;
-    std::vector<std::vector<QString>> m_thumbnailIds;
     PlaylistImporter *importer;
 };
 
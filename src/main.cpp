@@ -30,6 +30,9 @@
 #include "playerutils.h"
 #include "library.h"
 #include "thumbnailsource.h"
+#include "thumbnailcache.h"
+#include "thumbnailimageprovider.h"
+#include "playlistcoversource.h"
 #include "blur.h"
 #include "localplaylistmodel.h"
 #include "localplaylistsmodel.h"
@@ -88,6 +91,9 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
         KAboutData::setApplicationData(about);
     });
 
+    // Loads the index of the thumbnail cache in the background, while the UI is loading
+    ThumbnailCache::instance();
+
     QGuiApplication::setWindowIcon(QIcon::fromTheme(QStringLiteral("org.kde.audiotube")));
 
     KCrash::initialize();
@@ -128,9 +134,11 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
 
     qmlRegisterSingletonInstance<Library>(URI, 1, 0, "Library", &Library::instance());
     qmlRegisterType<ThumbnailSource>(URI, 1, 0, "ThumbnailSource");
+    qmlRegisterType<PlaylistCoverSource>(URI, 1, 0, "PlaylistCoverSource");
     qmlRegisterAnonymousType<FavouriteWatcher>(URI, 1);
     qmlRegisterAnonymousType<WasPlayedWatcher>(URI, 1);
 
+    engine.addImageProvider(QLatin1String(ThumbnailImageProvider::PROVIDER_ID), new ThumbnailImageProvider());
     engine.rootContext()->setContextObject(new KLocalizedContext(&engine));
     engine.load(QUrl(QStringLiteral("qrc:///main.qml")));
 
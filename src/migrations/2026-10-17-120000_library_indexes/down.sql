@@ -0,0 +1,10 @@
+-- SPDX-FileCopyrightText: 2026 agent <agent@local>
+--
+-- SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+drop index played_songs_plays;
+drop index played_songs_last_played;
+drop index playlist_entries_video_id;
+drop index searches_search_query;
+
+alter table played_songs drop column last_played;
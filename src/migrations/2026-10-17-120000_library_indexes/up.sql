@@ -0,0 +1,11 @@
+-- SPDX-FileCopyrightText: 2026 agent <agent@local>
+--
+-- SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+-- Songs played before this migration have no known play time, and stay null
+alter table played_songs add column last_played Timestamp;
+
+create index played_songs_plays on played_songs (plays);
+create index played_songs_last_played on played_songs (last_played);
+create index playlist_entries_video_id on playlist_entries (video_id);
+create index searches_search_query on searches (search_query, search_id);
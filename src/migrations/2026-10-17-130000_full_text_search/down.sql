@@ -0,0 +1,12 @@
+-- SPDX-FileCopyrightText: 2026 agent <agent@local>
+--
+-- SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+drop trigger if exists songs_fts_insert;
+drop trigger if exists songs_fts_delete;
+drop trigger if exists songs_fts_update;
+drop trigger if exists searches_fts_insert;
+drop trigger if exists searches_fts_delete;
+
+drop table songs_fts;
+drop table searches_fts;
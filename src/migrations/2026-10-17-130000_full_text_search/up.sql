@@ -0,0 +1,21 @@
+-- SPDX-FileCopyrightText: 2026 agent <agent@local>
+--
+-- SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+-- Full text indexes over the existing tables. They don't store a copy of the text.
+-- The triggers keeping them up to date are created by Library, as statements in migrations can't contain semicolons.
+create virtual table songs_fts using fts5 (
+    title, artist, album,
+    content = 'songs',
+    tokenize = 'unicode61 remove_diacritics 2'
+);
+
+create virtual table searches_fts using fts5 (
+    search_query,
+    content = 'searches',
+    content_rowid = 'search_id',
+    tokenize = 'unicode61 remove_diacritics 2'
+);
+
+insert into songs_fts (songs_fts) values ('rebuild');
+insert into searches_fts (searches_fts) values ('rebuild');
@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QModelIndex>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+namespace detail {
+
+/// Whether two rows can be compared. std::variant declares operator== for any alternatives,
+/// even if they can't be compared, so the alternatives are checked instead.
+template <typename T>
+constexpr bool isEqualityComparable = requires(const T &row) { row == row; };
+
+template <typename ...Alternatives>
+constexpr bool isEqualityComparable<std::variant<Alternatives...>> = (isEqualityComparable<Alternatives> && ...);
+
+}
+
+///
+/// Adds updateRows() to a list model, which replaces the rows of the model with new ones
+/// by emitting the row removals, moves and insertions that turn the old rows into the new rows.
+/// Unlike a model reset, this keeps the scroll position and selection of views intact,
+/// and only recreates the delegates of rows that actually changed.
+///
+template <typename Base>
+class KeyedListModel : public Base
+{
+public:
+    using Base::Base;
+
+protected:
+    /// Replaces rows with newRows. Rows are matched by the key returned by keyOf, which needs to be hashable.
+    /// keyOf can be anything std::invoke accepts, including a pointer to a data member.
+    /// Kept rows are only reported as changed if T has no operator== or compares unequal.
+    template <typename T, typename KeyFunc>
+    void updateRows(std::vector<T> &rows, std::vector<T> &&newRows, KeyFunc keyOf)
+    {
+        using Key = std::decay_t<std::invoke_result_t<KeyFunc, const T &>>;
+
+        std::unordered_set<Key> newKeys;
+        std::unordered_set<Key> oldKeys;
+        for (const auto &row : newRows) {
+            newKeys.insert(std::invoke(keyOf, row));
+        }
+        for (const auto &row : rows) {
+            oldKeys.insert(std::invoke(keyOf, row));
+        }
+
+        // Rows can't be matched if their keys are ambiguous
+        if (newKeys.size() != newRows.size() || oldKeys.size() != rows.size()) {
+            this->beginResetModel();
+            rows = std::move(newRows);
+            this->endResetModel();
+            return;
+        }
+
+        // Remove runs of rows that no longer exist, starting from the back so the indices stay valid
+        for (int last = int(rows.size()) - 1; last >= 0;) {
+            if (newKeys.contains(std::invoke(keyOf, rows[last]))) {
+                last--;
+                continue;
+            }
+
+            int first = last;
+            while (first > 0 && !newKeys.contains(std::invoke(keyOf, rows[first - 1]))) {
+                first--;
+            }
+
+            this->beginRemoveRows({}, first, last);
+            for (int i = first; i <= last; i++) {
+                oldKeys.erase(std::invoke(keyOf, rows[i]));
+            }
+            rows.erase(rows.begin() + first, rows.begin() + last + 1);
+            this->endRemoveRows();
+
+            last = first - 1;
+        }
+
+        // All rows before i are in their final place, all rows after it still exist in newRows
+        int changedFirst = -1;
+        const auto flushChanged = [&](int end) {
+            if (changedFirst >= 0) {
+                Q_EMIT this->dataChanged(this->index(changedFirst, 0), this->index(end - 1, 0));
+                changedFirst = -1;
+            }
+        };
+
+        for (int i = 0; i < int(newRows.size());) {
+            const auto key = std::invoke(keyOf, newRows[i]);
+
+            if (!oldKeys.contains(key)) {
+                flushChanged(i);
+
+                int end = i + 1;
+                while (end < int(newRows.size()) && !oldKeys.contains(std::invoke(keyOf, newRows[end]))) {
+                    end++;
+                }
+
+                this->beginInsertRows({}, i, end - 1);
+                rows.insert(rows.begin() + i,
+                            std::make_move_iterator(newRows.begin() + i),
+                            std::make_move_iterator(newRows.begin() + end));
+                this->endInsertRows();
+
+                i = end;
+                continue;
+            }
+
+            if (std::invoke(keyOf, rows[i]) != key) {
+                flushChanged(i);
+
+                const int from = int(std::find_if(rows.begin() + i + 1, rows.end(), [&](const T &row) {
+                    return std::invoke(keyOf, row) == key;
+                }) - rows.begin());
+
+                this->beginMoveRows({}, from, from, {}, i);
+                std::rotate(rows.begin() + i, rows.begin() + from, rows.begin() + from + 1);
+                this->endMoveRows();
+            }
+
+            bool changed = true;
+            if constexpr (detail::isEqualityComparable<T>) {
+                changed = !(rows[i] == newRows[i]);
+            }
+
+            if (changed) {
+                rows[i] = std::move(newRows[i]);
+                if (changedFirst < 0) {
+                    changedFirst = i;
+                }
+            } else {
+                flushChanged(i);
+            }
+
+            i++;
+        }
+
+        flushChanged(int(rows.size()));
+    }
+};
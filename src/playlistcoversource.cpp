@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "playlistcoversource.h"
+
+#include <QCryptographicHash>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QStringBuilder>
+#include <QtConcurrent>
+
+#include <QCoroFuture>
+#include <QCoroTask>
+
+#include "thumbnailcache.h"
+#include "thumbnailimageprovider.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace {
+
+constexpr int TILES = 4;
+// Logical size of one tile of the cover
+constexpr int TILE_SIZE = 100;
+
+QImage renderCover(const QStringList &thumbnails)
+{
+    const int size = 2 * TILE_SIZE * qGuiApp->devicePixelRatio();
+    const int tileSize = size / 2;
+
+    QImage cover(size, size, QImage::Format_ARGB32_Premultiplied);
+    cover.fill(Qt::transparent);
+
+    QPainter painter(&cover);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (int i = 0; i < TILES; i++) {
+        const QImage thumbnail = ThumbnailCache::instance().image(thumbnails[i]);
+        if (thumbnail.isNull()) {
+            continue;
+        }
+        const QRect tile((i % 2) * tileSize, (i / 2) * tileSize, tileSize, tileSize);
+        painter.drawImage(tile, thumbnail.scaled(tile.size(), Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    }
+    painter.end();
+
+    return cover;
+}
+
+}
+
+PlaylistCoverSource::~PlaylistCoverSource()
+{
+    releasePendingTiles();
+}
+
+void PlaylistCoverSource::setVideoIds(const QStringList &ids)
+{
+    if (m_videoIds == ids) {
+        return;
+    }
+
+    releasePendingTiles();
+    m_videoIds = ids;
+    Q_EMIT videoIdsChanged();
+    setCachedPath({});
+
+    if (ids.isEmpty()) {
+        return;
+    }
+
+    // Playlists with less than four songs repeat the first one
+    QStringList tiles = ids.mid(0, TILES);
+    while (tiles.size() < TILES) {
+        tiles.append(ids.first());
+    }
+
+    const auto key = QCryptographicHash::hash(tiles.join(u',').toUtf8(), QCryptographicHash::Sha1).toHex();
+    const QString name = u"cover-" % QString::fromLatin1(key);
+
+    QCoro::connect(ThumbnailCache::instance().lookup(name), this, [this, ids, tiles, name](const QString &cached) {
+        // Check if the songs were changed in the meantime
+        if (ids != m_videoIds) {
+            return;
+        }
+
+        if (cached.isEmpty()) {
+            render(tiles, name);
+        } else {
+            setCachedPath(ThumbnailImageProvider::url(name));
+        }
+    });
+}
+
+void PlaylistCoverSource::render(const QStringList &tiles, const QString &name)
+{
+    struct Render {
+        QStringList tiles;
+        QStringList thumbnails = QStringList(TILES);
+        int pending = TILES;
+    };
+    auto render = std::make_shared<Render>(Render { tiles });
+    const QStringList ids = m_videoIds;
+
+    m_pendingTiles = tiles;
+    for (int i = 0; i < TILES; i++) {
+        QCoro::connect(ThumbnailCache::instance().thumbnail(tiles[i], TILE_SIZE), this, [this, render, i, ids, name](const QString &thumbnail) {
+            if (ids != m_videoIds) {
+                return;
+            }
+
+            m_pendingTiles.removeOne(render->tiles[i]);
+            render->thumbnails[i] = thumbnail;
+            if (--render->pending > 0) {
+                return;
+            }
+
+            // Tiles whose thumbnail couldn't be downloaded stay empty, but a cover without any is not worth caching
+            if (std::ranges::all_of(render->thumbnails, &QString::isEmpty)) {
+                return;
+            }
+
+            // A cover with empty tiles is stored under another name, so it can be shown,
+            // but the next lookup of the cover doesn't find it and tries the missing tiles again.
+            const bool complete = std::ranges::none_of(render->thumbnails, &QString::isEmpty);
+            const QString stored = complete ? name : QString(u"partial-" % name);
+
+            auto future = QtConcurrent::run(ThumbnailCache::instance().imagePool(), [thumbnails = render->thumbnails, stored]() {
+                return ThumbnailCache::instance().write(stored, renderCover(thumbnails));
+            });
+            QCoro::connect(std::move(future), this, [this, ids, stored](qint64 size) {
+                if (size < 0) {
+                    return;
+                }
+                ThumbnailCache::instance().insert(stored, size);
+
+                // Check if the songs were changed since we started rendering
+                if (ids == m_videoIds) {
+                    setCachedPath(ThumbnailImageProvider::url(stored));
+                }
+            });
+        });
+    }
+}
+
+void PlaylistCoverSource::releasePendingTiles()
+{
+    for (const auto &tile : std::exchange(m_pendingTiles, {})) {
+        ThumbnailCache::instance().release(tile, TILE_SIZE);
+    }
+}
+
+void PlaylistCoverSource::setCachedPath(const QUrl &path)
+{
+    m_cachedPath = path;
+    Q_EMIT cachedPathChanged();
+}
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QUrl>
+
+///
+/// Provides the cover of a local playlist as one image, composed of the thumbnails of up to four of its songs.
+///
+/// The cover is rendered off the GUI thread and cached on disk under a name derived from the video ids,
+/// so it is rendered again whenever the songs shown on it change.
+///
+class PlaylistCoverSource : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(QStringList videoIds READ videoIds WRITE setVideoIds NOTIFY videoIdsChanged)
+    Q_PROPERTY(QUrl cachedPath READ cachedPath NOTIFY cachedPathChanged)
+
+public:
+    ~PlaylistCoverSource() override;
+
+    QStringList videoIds() const {
+        return m_videoIds;
+    }
+    void setVideoIds(const QStringList &ids);
+    Q_SIGNAL void videoIdsChanged();
+
+    QUrl cachedPath() const {
+        return m_cachedPath;
+    }
+    Q_SIGNAL void cachedPathChanged();
+
+private:
+    void render(const QStringList &tiles, const QString &name);
+    void setCachedPath(const QUrl &path);
+    void releasePendingTiles();
+
+    QStringList m_videoIds;
+    // Thumbnails requested from the cache that didn't arrive yet
+    QStringList m_pendingTiles;
+    QUrl m_cachedPath;
+};
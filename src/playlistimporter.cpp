@@ -6,6 +6,7 @@
 #include "playlistutils.h"
 
 #include "library.h"
+#include <QFutureWatcher>
 #include <qfuture.h>
 #include <qglobal.h>
 #include <qsqldatabase.h>
@@ -21,27 +22,31 @@ PlaylistImporter::PlaylistImporter(QObject* parent)
 void PlaylistImporter::importPlaylist(const QString &url)
 {
     const QString croppedURL = this->cropURL(url).toString(), title = i18n("Unknown"), description = i18n("No description");
-    QCoro::connect(Library::instance().database().execute("insert into playlists (title, description) values (?, ?)", title, description), &Library::instance(), [this, croppedURL]() {
-        QCoro::connect(Library::instance().database().getResults<SingleValue<qint64>>("select * from playlists"), &Library::instance(), [this, croppedURL](const auto& playlists) {
-            const quint64 playlistId = playlists.back().value;
-            Q_EMIT Library::instance().playlistsChanged();
-
-            QCoro::connect(YTMusicThread::instance()->fetchPlaylist(croppedURL), this, [this, playlistId](const auto& playlist) {
-                this->renamePlaylist(playlistId, QString::fromStdString(playlist.title), QString::fromStdString(playlist.author.name));
-
-                for (const auto& track : playlist.tracks) {
-                    if (track.is_available && track.video_id) {
-                        this->addPlaylistEntry(playlistId, track);
-                    }
-                }
-
-                Q_EMIT Library::instance().playlistsChanged();
-                Q_EMIT importFinished();
-            });
+    // The id is returned by the insert itself, so concurrent imports can't pick up each other's playlist
+    auto inserted = Library::instance().statements().getResult<SingleValue<qint64>>(
+        "insert into playlists (title, description) values (?, ?) returning playlist_id", title, description);
+    QCoro::connect(std::move(inserted), this, [this, croppedURL](auto playlist) {
+        if (!playlist) {
+            return;
+        }
+
+        const qint64 playlistId = playlist->value;
+        Q_EMIT Library::instance().playlistsChanged();
+
+        QCoro::connect(YTMusicThread::instance()->fetchPlaylist(croppedURL), this, [this, playlistId](const auto& playlist) {
+            this->renamePlaylist(playlistId, QString::fromStdString(playlist.title), QString::fromStdString(playlist.author.name));
+            this->importTracks(playlistId, playlist.tracks);
         });
     });
 }
 
+void PlaylistImporter::importPlaylists(const QStringList &urls)
+{
+    for (const auto &url : urls) {
+        importPlaylist(url);
+    }
+}
+
 void PlaylistImporter::addPlaylistEntry(qint64 playlistId, const QString &videoId, const QString &title, const QString &artist, const QString &album)
 {
     QCoro::connect(Library::instance().addSong(videoId, title, artist, album), this, [=, this] {
@@ -53,11 +58,47 @@ void PlaylistImporter::addPlaylistEntry(qint64 playlistId, const QString &videoI
 
 void PlaylistImporter::addPlaylistEntry(qint64 playlistId, const playlist::Track &track)
 {
-    const QString videoId = track.video_id.value().c_str();
-    const QString title   = (!track.title.empty()) ? QString::fromStdString(track.title) : i18n("No title");
-    const QString artists = PlaylistUtils::artistsToString(track.artists);
-    const QString album   = (track.album ) ? QString::fromStdString(track.album->name) : i18n("No album");
-    this->addPlaylistEntry(playlistId, videoId, title, artists, album);
+    auto song = trackToSong(track);
+    this->addPlaylistEntry(playlistId, song.videoId, song.title, song.artist, song.album);
+}
+
+void PlaylistImporter::importTracks(qint64 playlistId, const std::vector<playlist::Track> &tracks)
+{
+    std::vector<Song> songs;
+    songs.reserve(tracks.size());
+    for (const auto &track : tracks) {
+        if (track.is_available && track.video_id) {
+            songs.push_back(trackToSong(track));
+        }
+    }
+
+    // All tracks are written in one transaction, so there is only one change to announce
+    auto future = Library::instance().addPlaylistEntries(playlistId, songs);
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::progressValueChanged, this, [this, watcher, playlistId](int value) {
+        if (watcher->progressMaximum() > 0) {
+            Q_EMIT importProgress(playlistId, qreal(value) / watcher->progressMaximum());
+        }
+    });
+    connect(watcher, &QFutureWatcher<void>::finished, watcher, &QObject::deleteLater);
+    watcher->setFuture(future);
+
+    QCoro::connect(std::move(future), this, [this, playlistId] {
+        Q_EMIT playlistEntriesChanged(playlistId);
+        Q_EMIT Library::instance().playlistsChanged();
+        Q_EMIT importFinished();
+    });
+}
+
+Song PlaylistImporter::trackToSong(const playlist::Track &track)
+{
+    return Song {
+        QString::fromStdString(track.video_id.value()),
+        (!track.title.empty()) ? QString::fromStdString(track.title) : i18n("No title"),
+        PlaylistUtils::artistsToString(track.artists),
+        (track.album) ? QString::fromStdString(track.album->name) : i18n("No album"),
+    };
 }
 
 void PlaylistImporter::renamePlaylist(qint64 playlistId, const QString &name, const QString &description)
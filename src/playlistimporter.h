@@ -5,6 +5,7 @@
 #pragma once
 
 #include "ytmusic.h"
+#include "library.h"
 #include <QObject>
 #include <ThreadedDatabase>
 
@@ -16,7 +17,11 @@ public:
     PlaylistImporter(QObject *parent = nullptr);
 
     Q_INVOKABLE void importPlaylist(const QString &url);
+    /// Imports each playlist into its own new local playlist. The imports run in parallel.
+    Q_INVOKABLE void importPlaylists(const QStringList &urls);
     Q_SIGNAL void importFinished();
+    /// Share of the imported tracks of the playlist that has been written to the library, between 0 and 1
+    Q_SIGNAL void importProgress(qint64 playlistId, qreal progress);
     Q_INVOKABLE void addPlaylistEntry(qint64 playlistId, const QString &videoId, const QString &title, const QString &artist, const QString &album);
     Q_INVOKABLE void addPlaylistEntry(qint64 playlistId, const playlist::Track &track);
 
@@ -27,4 +32,6 @@ public:
 
 private:
     QStringView cropURL(QStringView srcURL);
+    void importTracks(qint64 playlistId, const std::vector<playlist::Track> &tracks);
+    static Song trackToSong(const playlist::Track &track);
 };
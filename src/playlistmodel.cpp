@@ -18,18 +18,41 @@ PlaylistModel::PlaylistModel(QObject *parent)
 {
     connect(this, &PlaylistModel::playlistIdChanged, this, [=, this] {
         setLoading(true);
-        auto future = YTMusicThread::instance()->fetchPlaylist(m_playlistId);
-        QCoro::connect(std::move(future), this, [=, this](const playlist::Playlist &playlist) {
-            setLoading(false);
-            beginResetModel();
-            m_playlist = playlist;
-            std::sort(m_playlist.thumbnails.begin(), m_playlist.thumbnails.end());
-            endResetModel();
-
-            Q_EMIT titleChanged();
-            Q_EMIT thumbnailUrlChanged();
-        });
+        m_pages.cancel();
+        m_pages.setFuture(YTMusicThread::instance()->fetchPlaylistPages(m_playlistId));
     });
+    connect(&m_pages, &QFutureWatcher<playlist::Playlist>::resultReadyAt, this, &PlaylistModel::handlePage);
+    connect(&m_pages, &QFutureWatcher<playlist::Playlist>::finished, this, [this] {
+        setLoading(false);
+    });
+}
+
+void PlaylistModel::handlePage(int index)
+{
+    auto page = m_pages.resultAt(index);
+
+    // The first page replaces the previous playlist, the following ones only contain more tracks
+    if (index == 0) {
+        beginResetModel();
+        m_playlist = std::move(page);
+        std::sort(m_playlist.thumbnails.begin(), m_playlist.thumbnails.end());
+        endResetModel();
+
+        Q_EMIT titleChanged();
+        Q_EMIT thumbnailUrlChanged();
+        return;
+    }
+
+    if (page.tracks.empty()) {
+        return;
+    }
+
+    const int first = int(m_playlist.tracks.size());
+    beginInsertRows({}, first, first + int(page.tracks.size()) - 1);
+    m_playlist.tracks.insert(m_playlist.tracks.end(),
+                             std::make_move_iterator(page.tracks.begin()),
+                             std::make_move_iterator(page.tracks.end()));
+    endInsertRows();
 }
 
 int PlaylistModel::rowCount(const QModelIndex &parent) const
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 #include <ytmusic.h>
 
 #include "abstractytmusicmodel.h"
@@ -52,7 +53,10 @@ public:
     playlist::Playlist playlist() const;
 
 private:
+    void handlePage(int index);
+
     QString m_playlistId;
+    QFutureWatcher<playlist::Playlist> m_pages;
 
     playlist::Playlist m_playlist {};
 };
@@ -0,0 +1,426 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "responsecache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringBuilder>
+
+#include <chrono>
+#include <variant>
+
+#include <ytmusic.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr quint32 CACHE_MAGIC = 0x41545243; // ATRC
+// Needs to be increased whenever one of the cached structs changes
+constexpr quint16 CACHE_FORMAT_VERSION = 1;
+
+template <typename T>
+constexpr std::chrono::seconds TIME_TO_LIVE = 0s;
+template <>
+constexpr std::chrono::seconds TIME_TO_LIVE<Lyrics> = std::chrono::days(7);
+template <>
+constexpr std::chrono::seconds TIME_TO_LIVE<album::Album> = std::chrono::days(3);
+template <>
+constexpr std::chrono::seconds TIME_TO_LIVE<artist::Artist> = std::chrono::days(1);
+template <>
+constexpr std::chrono::seconds TIME_TO_LIVE<playlist::Playlist> = 6h;
+template <>
+constexpr std::chrono::seconds TIME_TO_LIVE<std::vector<search::SearchResultItem>> = 10min;
+
+//
+// Lists the members of each struct, in the order they are serialized.
+// The same functions are used for reading and writing.
+//
+template <typename Archive>
+void members(Archive &ar, meta::Thumbnail &thumbnail) {
+    ar(thumbnail.url, thumbnail.width, thumbnail.height);
+}
+
+template <typename Archive>
+void members(Archive &ar, meta::Artist &artist) {
+    ar(artist.name, artist.id);
+}
+
+template <typename Archive>
+void members(Archive &ar, meta::Album &album) {
+    ar(album.name, album.id);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::Media &media) {
+    ar(media.video_id, media.title, media.artists, media.duration, media.thumbnails);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::Video &video) {
+    members(ar, static_cast<search::Media &>(video));
+    ar(video.views);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::Playlist &playlist) {
+    ar(playlist.browse_id, playlist.title, playlist.author, playlist.item_count, playlist.thumbnails);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::Song &song) {
+    members(ar, static_cast<search::Media &>(song));
+    ar(song.album, song.is_explicit);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::Album &album) {
+    ar(album.browse_id, album.title, album.type, album.artists, album.year, album.is_explicit, album.thumbnails);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::Artist &artist) {
+    ar(artist.browse_id, artist.artist, artist.shuffle_id, artist.radio_id, artist.thumbnails);
+}
+
+template <typename Archive>
+void members(Archive &ar, search::TopResult &result) {
+    ar(result.category, result.result_type, result.video_id, result.title, result.artists, result.thumbnails);
+}
+
+template <typename Archive, typename T>
+void members(Archive &ar, artist::Artist::Section<T> &section) {
+    ar(section.browse_id, section.results, section.params);
+}
+
+template <typename Archive>
+void members(Archive &ar, artist::Artist::Song::Album &album) {
+    ar(album.name, album.id);
+}
+
+template <typename Archive>
+void members(Archive &ar, artist::Artist::Song &song) {
+    ar(song.video_id, song.title, song.thumbnails, song.artist, song.album);
+}
+
+template <typename Archive>
+void members(Archive &ar, artist::Artist::Album &album) {
+    ar(album.title, album.thumbnails, album.year, album.browse_id, album.type);
+}
+
+template <typename Archive>
+void members(Archive &ar, artist::Artist::Video &video) {
+    ar(video.title, video.thumbnails, video.views, video.video_id, video.playlist_id);
+}
+
+template <typename Archive>
+void members(Archive &ar, artist::Artist::Single &single) {
+    ar(single.title, single.thumbnails, single.year, single.browse_id);
+}
+
+template <typename Archive>
+void members(Archive &ar, artist::Artist &artist) {
+    ar(artist.description, artist.views, artist.name, artist.channel_id, artist.subscribers, artist.subscribed,
+       artist.thumbnails, artist.songs, artist.albums, artist.singles, artist.videos);
+}
+
+template <typename Archive>
+void members(Archive &ar, album::Track &track) {
+    ar(track.is_explicit, track.title, track.artists, track.album, track.video_id, track.duration, track.like_status);
+}
+
+template <typename Archive>
+void members(Archive &ar, album::Album &album) {
+    ar(album.title, album.track_count, album.duration, album.audio_playlist_id, album.year, album.description,
+       album.thumbnails, album.tracks, album.artists);
+}
+
+template <typename Archive>
+void members(Archive &ar, playlist::Track &track) {
+    ar(track.video_id, track.title, track.artists, track.album, track.duration, track.like_status,
+       track.thumbnails, track.is_available, track.is_explicit);
+}
+
+template <typename Archive>
+void members(Archive &ar, playlist::Playlist &playlist) {
+    ar(playlist.id, playlist.privacy, playlist.title, playlist.thumbnails, playlist.author, playlist.year,
+       playlist.duration, playlist.track_count, playlist.tracks);
+}
+
+template <typename Archive>
+void members(Archive &ar, Lyrics &lyrics) {
+    ar(lyrics.source, lyrics.lyrics);
+}
+
+class Writer {
+public:
+    explicit Writer(QDataStream &stream)
+        : m_stream(stream)
+    {
+    }
+
+    template <typename ...Ts>
+    void operator()(const Ts &...values) {
+        (write(values), ...);
+    }
+
+private:
+    void write(const std::string &value) {
+        m_stream << QByteArray::fromStdString(value);
+    }
+
+    void write(int value) {
+        m_stream << qint32(value);
+    }
+
+    void write(bool value) {
+        m_stream << value;
+    }
+
+    void write(float value) {
+        m_stream << value;
+    }
+
+    template <typename T>
+    void write(const std::optional<T> &value) {
+        m_stream << value.has_value();
+        if (value) {
+            write(*value);
+        }
+    }
+
+    template <typename T>
+    void write(const std::vector<T> &values) {
+        m_stream << quint32(values.size());
+        for (const auto &value : values) {
+            write(value);
+        }
+    }
+
+    template <typename ...Ts>
+    void write(const std::variant<Ts...> &value) {
+        m_stream << quint8(value.index());
+        std::visit([this](const auto &alternative) {
+            write(alternative);
+        }, value);
+    }
+
+    template <typename T>
+    void write(const T &value) {
+        // members() is shared with the Reader, and never modifies the value when writing
+        members(*this, const_cast<T &>(value));
+    }
+
+    QDataStream &m_stream;
+};
+
+class Reader {
+public:
+    explicit Reader(QDataStream &stream)
+        : m_stream(stream)
+    {
+    }
+
+    template <typename ...Ts>
+    void operator()(Ts &...values) {
+        (read(values), ...);
+    }
+
+private:
+    void read(std::string &value) {
+        QByteArray bytes;
+        m_stream >> bytes;
+        value = bytes.toStdString();
+    }
+
+    void read(int &value) {
+        qint32 number = 0;
+        m_stream >> number;
+        value = number;
+    }
+
+    void read(bool &value) {
+        m_stream >> value;
+    }
+
+    void read(float &value) {
+        m_stream >> value;
+    }
+
+    template <typename T>
+    void read(std::optional<T> &value) {
+        bool hasValue = false;
+        m_stream >> hasValue;
+        if (hasValue) {
+            T inner {};
+            read(inner);
+            value = std::move(inner);
+        } else {
+            value.reset();
+        }
+    }
+
+    template <typename T>
+    void read(std::vector<T> &values) {
+        quint32 size = 0;
+        m_stream >> size;
+        values.clear();
+        for (quint32 i = 0; i < size && m_stream.status() == QDataStream::Ok; i++) {
+            T value {};
+            read(value);
+            values.push_back(std::move(value));
+        }
+    }
+
+    template <typename ...Ts>
+    void read(std::variant<Ts...> &value) {
+        quint8 index = 0;
+        m_stream >> index;
+        readAlternative<0>(value, index);
+    }
+
+    template <size_t I, typename ...Ts>
+    void readAlternative(std::variant<Ts...> &value, quint8 index) {
+        if constexpr (I < sizeof...(Ts)) {
+            if (index == I) {
+                std::variant_alternative_t<I, std::variant<Ts...>> alternative {};
+                read(alternative);
+                value = std::move(alternative);
+            } else {
+                readAlternative<I + 1>(value, index);
+            }
+        } else {
+            m_stream.setStatus(QDataStream::ReadCorruptData);
+        }
+    }
+
+    template <typename T>
+    void read(T &value) {
+        members(*this, value);
+    }
+
+    QDataStream &m_stream;
+};
+
+/// Reads the file header, and returns the expiry date of the entry if the header is valid
+std::optional<qint64> readHeader(QDataStream &stream) {
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 expiresAt = 0;
+    stream >> magic >> version >> expiresAt;
+
+    if (stream.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_FORMAT_VERSION) {
+        return std::nullopt;
+    }
+
+    return expiresAt;
+}
+
+}
+
+ResponseCache &ResponseCache::instance()
+{
+    static ResponseCache cache;
+    return cache;
+}
+
+ResponseCache::ResponseCache()
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) % QDir::separator() % "responses")
+{
+    QDir(m_directory).mkpath(QStringLiteral("."));
+    removeExpired();
+}
+
+template <typename T>
+std::optional<T> ResponseCache::lookup(const QString &key) const
+{
+    QFile file(filePath(key));
+    if (!file.open(QFile::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    const auto expiresAt = readHeader(stream);
+    if (!expiresAt || *expiresAt < QDateTime::currentMSecsSinceEpoch()) {
+        file.remove();
+        return std::nullopt;
+    }
+
+    T value {};
+    Reader reader(stream);
+    reader(value);
+
+    if (stream.status() != QDataStream::Ok) {
+        file.remove();
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+template <typename T>
+void ResponseCache::store(const QString &key, const T &value) const
+{
+    QSaveFile file(filePath(key));
+    if (!file.open(QFile::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    const qint64 expiresAt = QDateTime::currentMSecsSinceEpoch()
+        + std::chrono::duration_cast<std::chrono::milliseconds>(TIME_TO_LIVE<T>).count();
+    stream << CACHE_MAGIC << CACHE_FORMAT_VERSION << expiresAt;
+
+    Writer writer(stream);
+    writer(value);
+
+    file.commit();
+}
+
+QString ResponseCache::filePath(const QString &key) const
+{
+    const auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory % QDir::separator() % QString::fromLatin1(hash);
+}
+
+void ResponseCache::removeExpired() const
+{
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    const auto entries = QDir(m_directory).entryInfoList(QDir::Files);
+    for (const auto &entry : entries) {
+        QFile file(entry.absoluteFilePath());
+        if (!file.open(QFile::ReadOnly)) {
+            continue;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_6_0);
+        const auto expiresAt = readHeader(stream);
+        if (!expiresAt || *expiresAt < now) {
+            file.remove();
+        }
+    }
+}
+
+template std::optional<album::Album> ResponseCache::lookup(const QString &) const;
+template std::optional<artist::Artist> ResponseCache::lookup(const QString &) const;
+template std::optional<playlist::Playlist> ResponseCache::lookup(const QString &) const;
+template std::optional<Lyrics> ResponseCache::lookup(const QString &) const;
+template std::optional<std::vector<search::SearchResultItem>> ResponseCache::lookup(const QString &) const;
+
+template void ResponseCache::store(const QString &, const album::Album &) const;
+template void ResponseCache::store(const QString &, const artist::Artist &) const;
+template void ResponseCache::store(const QString &, const playlist::Playlist &) const;
+template void ResponseCache::store(const QString &, const Lyrics &) const;
+template void ResponseCache::store(const QString &, const std::vector<search::SearchResultItem> &) const;
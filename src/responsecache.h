@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QString>
+
+#include <optional>
+
+///
+/// Persistent cache for ytmusicapi responses.
+///
+/// Entries are stored in a compact binary format in the cache directory,
+/// and expire after a time that depends on their type, so lyrics and albums live for days,
+/// while search results are only kept for a few minutes.
+///
+/// Supported types are album::Album, artist::Artist, playlist::Playlist, Lyrics
+/// and std::vector<search::SearchResultItem>. All functions are thread safe.
+///
+class ResponseCache
+{
+public:
+    static ResponseCache &instance();
+
+    /// Returns the cached value for the key, if there is one that has not expired yet
+    template <typename T>
+    std::optional<T> lookup(const QString &key) const;
+
+    template <typename T>
+    void store(const QString &key, const T &value) const;
+
+private:
+    ResponseCache();
+
+    QString filePath(const QString &key) const;
+    void removeExpired() const;
+
+    QString m_directory;
+};
@@ -7,26 +7,40 @@
 
 #include <ranges>
 
+using namespace std::chrono_literals;
+
+constexpr auto DEFAULT_DEBOUNCE_INTERVAL = 300ms;
+
 SearchModel::SearchModel(QObject *parent)
-    : AbstractYTMusicModel(parent)
+    : KeyedListModel<AbstractYTMusicModel>(parent)
 {
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(DEFAULT_DEBOUNCE_INTERVAL);
+
     connect(this, &SearchModel::searchQueryChanged, this, [this] {
+        // Results for the previous query are not needed anymore
+        m_search.cancel();
+
         if (m_searchQuery.isEmpty()) {
-            beginResetModel();
-            m_searchResults.clear();
-            endResetModel();
+            m_debounceTimer.stop();
+            setLoading(false);
+            updateRows(m_searchResults, {}, &SearchModel::itemKey);
             return;
         }
 
         setLoading(true);
-        auto future = YTMusicThread::instance()->search(m_searchQuery);
-        QCoro::connect(std::move(future), this, [=, this](const std::vector<search::SearchResultItem> &results) {
-            beginResetModel();
-            setLoading(false);
-            m_searchResults = results;
+        m_debounceTimer.start();
+    });
+    connect(&m_debounceTimer, &QTimer::timeout, this, [this] {
+        m_search.setFuture(YTMusicThread::instance()->search(m_searchQuery));
+    });
+    connect(&m_search, &QFutureWatcher<std::vector<search::SearchResultItem>>::finished, this, [this] {
+        if (m_search.isCanceled() || m_search.future().resultCount() == 0) {
+            return;
+        }
 
-            endResetModel();
-        });
+        setLoading(false);
+        updateRows(m_searchResults, m_search.result(), &SearchModel::itemKey);
     });
     connect(&YTMusicThread::instance().get(), &AsyncYTMusic::errorOccurred, this, [this] {
         setLoading(false);
@@ -192,6 +206,21 @@ void SearchModel::setSearchQuery(const QString &searchQuery)
     Q_EMIT searchQueryChanged();
 }
 
+int SearchModel::debounceInterval() const
+{
+    return m_debounceTimer.interval();
+}
+
+void SearchModel::setDebounceInterval(int debounceInterval)
+{
+    if (m_debounceTimer.interval() == debounceInterval) {
+        return;
+    }
+
+    m_debounceTimer.setInterval(debounceInterval);
+    Q_EMIT debounceIntervalChanged();
+}
+
 void SearchModel::triggerItem(int row)
 {
     std::visit([&](auto&& arg) {
@@ -244,3 +273,22 @@ int SearchModel::itemType(search::SearchResultItem const &item)
         }
     }, item);
 }
+
+std::string SearchModel::itemKey(search::SearchResultItem const &item)
+{
+    // The same song or video may be returned as top result and as normal result, so the type is part of the key
+    return std::to_string(item.index()) + ':' + std::visit([&](auto &&arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr(std::is_same_v<T, search::Album>) {
+            return arg.browse_id.value_or(arg.title);
+        } else if constexpr(std::is_same_v<T, search::Artist> || std::is_same_v<T, search::Playlist>) {
+            return arg.browse_id;
+        } else if constexpr(std::is_same_v<T, search::Song> || std::is_same_v<T, search::Video>) {
+            return arg.video_id;
+        } else if constexpr(std::is_same_v<T, search::TopResult>) {
+            return arg.video_id.value_or(arg.title.value_or(std::string()));
+        } else {
+            Q_UNREACHABLE();
+        }
+    }, item);
+}
@@ -5,16 +5,21 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 #include <QThread>
+#include <QTimer>
 
 #include "asyncytmusic.h"
 #include "abstractytmusicmodel.h"
+#include "modeldiff.h"
 
-class SearchModel : public AbstractYTMusicModel
+class SearchModel : public KeyedListModel<AbstractYTMusicModel>
 {
     Q_OBJECT
 
     Q_PROPERTY(QString searchQuery READ searchQuery WRITE setSearchQuery NOTIFY searchQueryChanged)
+    /// Time in milliseconds that the query needs to stay the same before it is searched for
+    Q_PROPERTY(int debounceInterval READ debounceInterval WRITE setDebounceInterval NOTIFY debounceIntervalChanged)
 
 public:
     enum Type {
@@ -47,6 +52,10 @@ public:
     void setSearchQuery(const QString &searchQuery);
     Q_SIGNAL void searchQueryChanged();
 
+    int debounceInterval() const;
+    void setDebounceInterval(int debounceInterval);
+    Q_SIGNAL void debounceIntervalChanged();
+
     Q_INVOKABLE void triggerItem(int row);
 
     Q_SIGNAL void openAlbum(const QString &browseId);
@@ -58,5 +67,8 @@ public:
 private:
     QString m_searchQuery;
     std::vector<search::SearchResultItem> m_searchResults;
+    QFutureWatcher<std::vector<search::SearchResultItem>> m_search;
+    QTimer m_debounceTimer;
     static int itemType(search::SearchResultItem const &item);
+    static std::string itemKey(search::SearchResultItem const &item);
 };
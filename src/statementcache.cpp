@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "statementcache.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include <QSqlDatabase>
+#include <QSqlError>
+
+#include <algorithm>
+
+StatementCache::StatementCache(ThreadedDatabase &database)
+    : m_database(database)
+    , m_state(std::make_shared<State>())
+{
+}
+
+StatementCache::~StatementCache()
+{
+    if (qEnvironmentVariableIsSet("AUDIOTUBE_SQL_STATISTICS")) {
+        auto statistics = this->statistics().result();
+        std::ranges::sort(statistics, std::greater(), &StatementStatistics::totalTime);
+        for (const auto &statement : statistics) {
+            qDebug().nospace() << statement.executions << " executions, "
+                               << std::chrono::duration_cast<std::chrono::microseconds>(statement.totalTime).count() << " µs total, "
+                               << std::chrono::duration_cast<std::chrono::microseconds>(statement.maxTime).count() << " µs max: "
+                               << statement.sqlQuery;
+        }
+    }
+
+    // Prepared statements belong to the connection, so they have to be finalized on its thread
+    m_database.runOnThread([state = m_state](const QSqlDatabase &) {
+        state->statements.clear();
+    }).waitForFinished();
+}
+
+QFuture<void> StatementCache::executeInTransaction(std::vector<std::pair<QString, QVariantList>> &&statements)
+{
+    QFutureInterface<void> interface;
+    interface.setProgressRange(0, int(statements.size()));
+    interface.reportStarted();
+
+    m_database.runOnThread([state = m_state, statements = std::move(statements), interface](const QSqlDatabase &connection) mutable {
+        QSqlDatabase database = connection;
+        if (!database.transaction()) {
+            qWarning() << "Failed to start transaction" << database.lastError();
+            interface.reportCanceled();
+            interface.reportFinished();
+            return;
+        }
+
+        for (const auto &[sqlQuery, arguments] : statements) {
+            // Nothing of the transaction is applied if one of its statements fails
+            if (!state->run(database, sqlQuery, arguments, [](QSqlQuery &) {})) {
+                database.rollback();
+                interface.reportCanceled();
+                interface.reportFinished();
+                return;
+            }
+            interface.setProgressValue(interface.progressValue() + 1);
+        }
+
+        if (!database.commit()) {
+            qWarning() << "Failed to commit transaction" << database.lastError();
+            database.rollback();
+            interface.reportCanceled();
+        }
+        interface.reportFinished();
+    });
+
+    return interface.future();
+}
+
+QFuture<std::vector<StatementStatistics>> StatementCache::statistics() const
+{
+    return m_database.runOnThread([state = m_state](const QSqlDatabase &) {
+        std::vector<StatementStatistics> statistics;
+        statistics.reserve(state->statements.size());
+        for (const auto &[sqlQuery, statement] : state->statements) {
+            statistics.push_back(statement.statistics);
+        }
+        return statistics;
+    });
+}
+
+bool StatementCache::State::run(const QSqlDatabase &database, const QString &sqlQuery, const QVariantList &arguments,
+                                const std::function<void(QSqlQuery &)> &readResults)
+{
+    auto it = statements.find(sqlQuery);
+    if (it == statements.end()) {
+        QSqlQuery query(database);
+        query.setForwardOnly(true);
+        if (!query.prepare(sqlQuery)) {
+            qWarning() << "Failed to prepare" << sqlQuery << query.lastError();
+            return false;
+        }
+
+        it = statements.emplace(sqlQuery, Statement { std::move(query), StatementStatistics { sqlQuery } }).first;
+    }
+
+    auto &[query, statistics] = it->second;
+    for (int i = 0; i < arguments.size(); i++) {
+        query.bindValue(i, arguments[i]);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool success = query.exec();
+    if (success) {
+        readResults(query);
+    } else {
+        qWarning() << "Failed to execute" << sqlQuery << query.lastError();
+    }
+    // Reset the statement, so it doesn't keep a read transaction open until the next execution
+    query.finish();
+
+    const auto elapsed = std::chrono::nanoseconds(timer.nsecsElapsed());
+    statistics.executions++;
+    statistics.totalTime += elapsed;
+    statistics.maxTime = std::max(statistics.maxTime, elapsed);
+
+    return success;
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QFuture>
+#include <QSqlQuery>
+#include <QString>
+#include <QVariant>
+
+#include <ThreadedDatabase>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct StatementStatistics {
+    QString sqlQuery;
+    quint64 executions = 0;
+    std::chrono::nanoseconds totalTime {};
+    std::chrono::nanoseconds maxTime {};
+};
+
+///
+/// Runs queries on the thread of a ThreadedDatabase, like ThreadedDatabase itself,
+/// but prepares each distinct query only once and reuses the prepared statement with new parameters.
+///
+/// It also measures how often each statement is executed and how long that takes.
+/// If the AUDIOTUBE_SQL_STATISTICS environment variable is set, they are printed when the cache is destroyed.
+///
+class StatementCache
+{
+public:
+    explicit StatementCache(ThreadedDatabase &database);
+    ~StatementCache();
+
+    template <typename T, typename ...Args>
+    QFuture<std::vector<T>> getResults(const QString &sqlQuery, const Args &...args) {
+        return m_database.runOnThread([state = m_state, sqlQuery, arguments = bindValues(args...)](const QSqlDatabase &database) {
+            std::vector<T> results;
+            state->run(database, sqlQuery, arguments, [&](QSqlQuery &query) {
+                while (query.next()) {
+                    results.push_back(parseRow<T>(query));
+                }
+            });
+            return results;
+        });
+    }
+
+    template <typename T, typename ...Args>
+    QFuture<std::optional<T>> getResult(const QString &sqlQuery, const Args &...args) {
+        return m_database.runOnThread([state = m_state, sqlQuery, arguments = bindValues(args...)](const QSqlDatabase &database) {
+            std::optional<T> result;
+            state->run(database, sqlQuery, arguments, [&](QSqlQuery &query) {
+                if (query.next()) {
+                    result = parseRow<T>(query);
+                }
+            });
+            return result;
+        });
+    }
+
+    template <typename ...Args>
+    QFuture<void> execute(const QString &sqlQuery, const Args &...args) {
+        return m_database.runOnThread([state = m_state, sqlQuery, arguments = bindValues(args...)](const QSqlDatabase &database) {
+            state->run(database, sqlQuery, arguments, [](QSqlQuery &) {});
+        });
+    }
+
+    /// Executes all statements in one transaction.
+    /// The progress value of the returned future counts the statements that were executed so far.
+    /// If one of the statements fails, the transaction is rolled back and the returned future is canceled.
+    QFuture<void> executeInTransaction(std::vector<std::pair<QString, QVariantList>> &&statements);
+
+    QFuture<std::vector<StatementStatistics>> statistics() const;
+
+private:
+    struct Statement {
+        QSqlQuery query;
+        StatementStatistics statistics;
+    };
+
+    /// Only accessed on the database thread
+    struct State {
+        /// Returns whether the statement could be executed
+        bool run(const QSqlDatabase &database, const QString &sqlQuery, const QVariantList &arguments,
+                 const std::function<void(QSqlQuery &)> &readResults);
+
+        std::unordered_map<QString, Statement> statements;
+    };
+
+    template <typename ...Args>
+    static QVariantList bindValues(const Args &...args) {
+        return QVariantList { QVariant::fromValue(args)... };
+    }
+
+    template <typename T>
+    static T parseRow(const QSqlQuery &query) {
+        using Columns = typename T::ColumnTypes;
+        return T::fromSql([&]<size_t ...I>(std::index_sequence<I...>) {
+            return Columns { query.value(int(I)).template value<std::tuple_element_t<I, Columns>>()... };
+        }(std::make_index_sequence<std::tuple_size_v<Columns>>()));
+    }
+
+    ThreadedDatabase &m_database;
+    std::shared_ptr<State> m_state;
+};
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "streamurlcache.h"
+
+#include <QDateTime>
+#include <QUrl>
+#include <QUrlQuery>
+
+#include <algorithm>
+
+// Evict entries this long before the URL expires, so playback doesn't start with an URL that is about to lapse
+constexpr qint64 EXPIRY_MARGIN_MSECS = 5 * 60 * 1000;
+// Used for URLs that don't contain an expiry date
+constexpr qint64 DEFAULT_LIFETIME_MSECS = 60 * 60 * 1000;
+
+std::optional<video_info::VideoInfo> StreamUrlCache::lookup(const QString &videoId)
+{
+    std::scoped_lock lock(m_mutex);
+
+    auto it = m_entries.find(videoId);
+    if (it == m_entries.end()) {
+        return std::nullopt;
+    }
+
+    if (it->expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+        m_entries.erase(it);
+        return std::nullopt;
+    }
+
+    return it->info;
+}
+
+void StreamUrlCache::store(const QString &videoId, const video_info::VideoInfo &info)
+{
+    const auto format = bestAudioFormat(info);
+    if (!format) {
+        return;
+    }
+
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+
+    bool ok = false;
+    const qint64 expire = QUrlQuery(QUrl(QString::fromStdString(format->url)))
+        .queryItemValue(QStringLiteral("expire"))
+        .toLongLong(&ok);
+    const qint64 expiresAt = ok ? expire * 1000 - EXPIRY_MARGIN_MSECS : now + DEFAULT_LIFETIME_MSECS;
+
+    if (expiresAt <= now) {
+        return;
+    }
+
+    // Only keep what is needed for playback
+    auto entry = Entry { info, expiresAt };
+    entry.info.formats = { *format };
+
+    std::scoped_lock lock(m_mutex);
+    removeExpired(now);
+    m_entries.insert(videoId, std::move(entry));
+}
+
+std::optional<video_info::Format> StreamUrlCache::bestAudioFormat(const video_info::VideoInfo &info)
+{
+    std::optional<video_info::Format> best;
+
+    for (const auto &format : info.formats) {
+        // filter audio only formats
+        if (format.acodec == "none" || format.vcodec != "none") {
+            continue;
+        }
+
+        if (!best || format.quality > best->quality) {
+            best = format;
+        }
+    }
+
+    return best;
+}
+
+void StreamUrlCache::removeExpired(qint64 now)
+{
+    m_entries.removeIf([now](const auto &entry) {
+        return entry.value().expiresAt <= now;
+    });
+}
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <mutex>
+#include <optional>
+
+#include <ytmusic.h>
+
+///
+/// In-memory cache of resolved audio streams, keyed by video id.
+///
+/// Stream URLs contain the time at which they stop working in their expire= query parameter.
+/// Entries are evicted shortly before that, so a cached URL is still valid when playback starts.
+/// All functions are thread safe.
+///
+class StreamUrlCache
+{
+public:
+    /// Returns the cached video info. Its formats only contain the selected audio format.
+    std::optional<video_info::VideoInfo> lookup(const QString &videoId);
+    void store(const QString &videoId, const video_info::VideoInfo &info);
+
+    /// Selects the audio only format with the highest quality
+    static std::optional<video_info::Format> bestAudioFormat(const video_info::VideoInfo &info);
+
+private:
+    struct Entry {
+        video_info::VideoInfo info;
+        qint64 expiresAt;
+    };
+
+    void removeExpired(qint64 now);
+
+    std::mutex m_mutex;
+    QHash<QString, Entry> m_entries;
+};
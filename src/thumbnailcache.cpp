@@ -0,0 +1,548 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "thumbnailcache.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringBuilder>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <QCoroFuture>
+#include <QCoroTask>
+
+#include "asyncytmusic.h"
+#include "library.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Increase to clear the cache, for example when thumbnails are stored in a different size
+constexpr auto CURRENT_CACHE_VERSION = 3;
+
+// Thumbnails are small, so a few parallel downloads are enough to saturate most connections
+constexpr int MAX_CONCURRENT_DOWNLOADS = 4;
+
+// Thumbnails used to be stored in a file each
+constexpr QLatin1String LEGACY_FILE_SUFFIX(".webp");
+// Contains the access times of the entries
+constexpr QLatin1String INDEX_FILE("/.index");
+
+constexpr quint32 INDEX_MAGIC = 0x41545449; // ATTI
+constexpr quint16 INDEX_FORMAT_VERSION = 1;
+
+constexpr qint64 DEFAULT_BUDGET_MIB = 200;
+// Evicting a bit more than necessary avoids evicting again for every new entry
+constexpr double EVICTION_TARGET = 0.9;
+constexpr auto INDEX_SAVE_DELAY = 30s;
+
+using Index = QHash<QString, ThumbnailCache::Entry>;
+
+std::optional<Index> readIndex(const QString &cacheDir)
+{
+    QFile file(cacheDir % INDEX_FILE);
+    if (!file.open(QFile::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != INDEX_MAGIC || version != INDEX_FORMAT_VERSION || count < 0) {
+        return std::nullopt;
+    }
+
+    Index index;
+    index.reserve(count);
+    for (qint32 i = 0; i < count; i++) {
+        QString name;
+        ThumbnailCache::Entry entry;
+        stream >> name >> entry.size >> entry.lastAccess;
+        index.insert(name, entry);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+void writeIndex(const QString &cacheDir, const Index &index)
+{
+    QSaveFile file(cacheDir % INDEX_FILE);
+    if (!file.open(QFile::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << INDEX_MAGIC << INDEX_FORMAT_VERSION << qint32(index.size());
+    for (auto it = index.begin(); it != index.end(); it++) {
+        stream << it.key() << it->size << it->lastAccess;
+    }
+    file.commit();
+}
+
+///
+/// Creates the cache directory, clears it if it was written by an older version, opens the pack and loads the index.
+/// Runs on a worker thread.
+///
+Index loadIndex(const QString &cacheDir, ThumbnailPack &pack)
+{
+    QDir(cacheDir).mkpath(QStringLiteral("."));
+
+    // Clear cache if it is old, so people can profit from memory usage improvements from downscaling,
+    // and get the new cropped thumbnails
+    auto cacheVersionFile = QString(cacheDir % "/.cache_version");
+
+    auto getCacheVersion = [cacheVersionFile]() {
+        QFile file(cacheVersionFile);
+        if (!file.open(QFile::ReadOnly)) {
+            return 0;
+        }
+        auto version = file.read(3); // Read at most three characters, we will not need more soon
+        return version.toInt();
+    };
+
+    if (!QFile::exists(cacheVersionFile) || getCacheVersion() < CURRENT_CACHE_VERSION) {
+        qDebug() << "Deleting and re-generating thumbnail cache";
+
+        QDir dir(cacheDir);
+        const auto entries = dir.entryList({ QLatin1Char('*') % LEGACY_FILE_SUFFIX }, QDir::Files);
+        for (const auto &thumbnail : entries) {
+            QFile::remove(cacheDir % "/" % thumbnail);
+        }
+        QFile::remove(cacheDir % INDEX_FILE);
+        ThumbnailPack::clear(cacheDir);
+
+        QFile file(cacheVersionFile);
+        if (file.open(QFile::WriteOnly)) {
+            file.seek(0);
+            file.write(QString::number(CURRENT_CACHE_VERSION).toUtf8());
+        }
+    }
+
+    // The pack knows which entries exist, the index only adds when they were used.
+    // Entries without an access time, for example because the index was lost, count as used now.
+    const auto sizes = pack.open();
+    const auto accessTimes = readIndex(cacheDir).value_or(Index());
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    Index index;
+    index.reserve(sizes.size());
+    for (auto it = sizes.begin(); it != sizes.end(); it++) {
+        const auto accessed = accessTimes.constFind(it.key());
+        index.insert(it.key(), ThumbnailCache::Entry { *it, accessed != accessTimes.cend() ? accessed->lastAccess : now });
+    }
+    return index;
+}
+
+int bucketFor(int size)
+{
+    const auto bucket = std::ranges::find_if(ThumbnailCache::SIZE_BUCKETS, [size](int bucket) {
+        return bucket >= size;
+    });
+    return bucket == ThumbnailCache::SIZE_BUCKETS.end() ? ThumbnailCache::SIZE_BUCKETS.back() : *bucket;
+}
+
+/// Scales the image to fill a square of the bucket size in device pixels, and crops the center
+QImage squareThumbnail(const QImage &image, int bucket)
+{
+    const int targetSize = bucket * qGuiApp->devicePixelRatio();
+    auto scaled = image.scaled(targetSize, targetSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    return scaled.copy(QRect((scaled.width() - targetSize) / 2, (scaled.height() - targetSize) / 2, targetSize, targetSize));
+}
+
+}
+
+ThumbnailCache &ThumbnailCache::instance()
+{
+    static ThumbnailCache cache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) % QDir::separator() % "thumbnails",
+                                Library::instance().nam());
+    return cache;
+}
+
+ThumbnailCache::ThumbnailCache(const QString &directory, QNetworkAccessManager &nam)
+    : m_directory(directory)
+    , m_nam(nam)
+    , m_budget([] {
+        bool ok = false;
+        const qint64 mebibytes = qEnvironmentVariableIntValue("AUDIOTUBE_THUMBNAIL_CACHE_SIZE", &ok);
+        return (ok && mebibytes > 0 ? mebibytes : DEFAULT_BUDGET_MIB) * 1024 * 1024;
+    }())
+    , m_pack(m_directory)
+{
+    m_imagePool.setMaxThreadCount(QThread::idealThreadCount());
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(INDEX_SAVE_DELAY);
+    connect(&m_saveTimer, &QTimer::timeout, this, &ThumbnailCache::saveIndex);
+
+    // Keep the access times of this session
+    if (auto *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, [this] {
+            if (m_loaded && m_saveTimer.isActive()) {
+                m_saveTimer.stop();
+                writeIndex(m_directory, m_index);
+                m_pack.saveIndex();
+            }
+        });
+    }
+
+    QCoro::connect(QtConcurrent::run(&m_imagePool, loadIndex, m_directory, std::ref(m_pack)), this, [this](auto index) {
+        // Entries may have been added while the index was loading
+        for (auto it = index.begin(); it != index.end(); it++) {
+            if (!m_index.contains(it.key())) {
+                m_index.insert(it.key(), *it);
+            }
+        }
+        m_totalSize = 0;
+        for (const auto &entry : std::as_const(m_index)) {
+            m_totalSize += entry.size;
+        }
+        m_loaded = true;
+
+        for (const auto &function : std::exchange(m_waitingForIndex, {})) {
+            function();
+        }
+        startDownloads();
+        evict();
+    });
+}
+
+QString ThumbnailCache::entryName(const QString &videoId, int size)
+{
+    return videoId % u'@' % QString::number(bucketFor(size));
+}
+
+QFuture<QString> ThumbnailCache::thumbnail(const QString &videoId, int size)
+{
+    const QString name = entryName(videoId, size);
+    if (m_loaded && touch(name)) {
+        return QtFuture::makeReadyFuture(name);
+    }
+
+    auto &download = m_downloads[name];
+    if (!download.result.isStarted()) {
+        download.videoId = videoId;
+        download.bucket = bucketFor(size);
+        download.result.reportStarted();
+    }
+    download.waiters++;
+
+    // Requesting a queued thumbnail again moves it to the front
+    if (download.state == Download::Queued) {
+        m_queue.erase(download.queuePosition);
+        download.queuePosition = ++m_requests;
+        m_queue.emplace(download.queuePosition, name);
+        startDownloads();
+    }
+
+    return download.result.future();
+}
+
+void ThumbnailCache::release(const QString &videoId, int size)
+{
+    const QString name = entryName(videoId, size);
+    auto it = m_downloads.find(name);
+    if (it == m_downloads.end() || --it->waiters > 0) {
+        return;
+    }
+
+    switch (it->state) {
+    case Download::Queued:
+        m_queue.erase(it->queuePosition);
+        finishDownload(name, false);
+        break;
+    case Download::Downloading:
+        // Finishes the download through store()
+        if (it->reply) {
+            it->reply->abort();
+        }
+        break;
+    case Download::Scaling:
+        // Almost done, and worth keeping in the cache
+        break;
+    }
+}
+
+QFuture<QString> ThumbnailCache::lookup(const QString &name)
+{
+    QFutureInterface<QString> interface;
+    interface.reportStarted();
+
+    whenLoaded([this, name, interface]() mutable {
+        interface.reportResult(touch(name) ? name : QString());
+        interface.reportFinished();
+    });
+
+    return interface.future();
+}
+
+void ThumbnailCache::insert(const QString &name, qint64 size)
+{
+    const auto previous = m_index.value(name);
+    m_totalSize += size - previous.size;
+    m_index.insert(name, Entry { size, QDateTime::currentSecsSinceEpoch() });
+
+    if (m_loaded) {
+        m_saveTimer.start();
+        evict();
+    }
+}
+
+qint64 ThumbnailCache::write(const QString &name, const QImage &image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QBuffer::WriteOnly);
+    if (!image.save(&buffer, "WEBP")) {
+        return -1;
+    }
+
+    return m_pack.append(name, data);
+}
+
+QImage ThumbnailCache::image(const QString &name) const
+{
+    return m_pack.image(name);
+}
+
+QThreadPool *ThumbnailCache::imagePool()
+{
+    return &m_imagePool;
+}
+
+void ThumbnailCache::whenLoaded(std::function<void()> &&function)
+{
+    if (m_loaded) {
+        function();
+    } else {
+        m_waitingForIndex.push_back(std::move(function));
+    }
+}
+
+void ThumbnailCache::startDownloads()
+{
+    while (m_loaded && m_running < MAX_CONCURRENT_DOWNLOADS && !m_queue.empty()) {
+        const auto newest = std::prev(m_queue.end());
+        const QString name = newest->second;
+        m_queue.erase(newest);
+
+        // May have been requested before the index was loaded
+        if (touch(name)) {
+            finishDownload(name, true);
+            continue;
+        }
+
+        auto &download = m_downloads[name];
+        download.queuePosition = 0;
+
+        // Smaller sizes don't need to be downloaded again
+        if (m_index.contains(entryName(download.videoId, SIZE_BUCKETS.back()))) {
+            download.state = Download::Scaling;
+            scaleDown(name);
+            continue;
+        }
+
+        download.state = Download::Downloading;
+        m_running++;
+        fetch(name);
+    }
+}
+
+void ThumbnailCache::fetch(const QString &name)
+{
+    const QString videoId = m_downloads[name].videoId;
+    auto *reply = m_nam.get(QNetworkRequest(QUrl("https://i.ytimg.com/vi_webp/" % videoId % "/maxresdefault.webp")));
+    m_downloads[name].reply = reply;
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, name, videoId]() {
+        if (reply->error() != QNetworkReply::NetworkError::ContentNotFoundError) {
+            store(name, reply);
+            return;
+        }
+
+        qDebug() << "Naive thumbnail resolution failed, falling back to yt-dlp (slower)";
+        reply->deleteLater();
+
+        QCoro::connect(YTMusicThread::instance()->extractVideoInfo(videoId), this, [this, name](auto info) {
+            // Nobody is waiting for the thumbnail anymore
+            if (m_downloads.value(name).waiters == 0) {
+                finishDownload(name, false);
+                startDownloads();
+                return;
+            }
+
+            auto *reply = m_nam.get(QNetworkRequest(QUrl(QString::fromStdString(info.thumbnail))));
+            m_downloads[name].reply = reply;
+            connect(reply, &QNetworkReply::finished, this, [this, reply, name]() {
+                store(name, reply);
+            });
+        });
+    });
+}
+
+void ThumbnailCache::store(const QString &name, QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (reply->error() != QNetworkReply::NoError) {
+        finishDownload(name, false);
+        startDownloads();
+        return;
+    }
+
+    // The next download can start while this one is being scaled
+    m_running--;
+    auto &download = m_downloads[name];
+    download.state = Download::Scaling;
+    startDownloads();
+
+    // Always store the largest size, so other sizes can be created from it later
+    const QString largestName = entryName(download.videoId, SIZE_BUCKETS.back());
+    auto future = QtConcurrent::run(&m_imagePool, [this, data = reply->readAll(), bucket = download.bucket, name, largestName]() {
+        const auto image = QImage::fromData(data);
+        const qint64 largestSize = write(largestName, squareThumbnail(image, SIZE_BUCKETS.back()));
+        if (largestSize < 0 || bucket == SIZE_BUCKETS.back()) {
+            return std::pair { largestSize, largestSize };
+        }
+        return std::pair { largestSize, write(name, squareThumbnail(image, bucket)) };
+    });
+
+    QCoro::connect(std::move(future), this, [this, name, largestName](auto sizes) {
+        const auto [largestSize, size] = sizes;
+        if (largestSize >= 0) {
+            insert(largestName, largestSize);
+        }
+        if (size >= 0) {
+            insert(name, size);
+        }
+        finishDownload(name, size >= 0);
+    });
+}
+
+void ThumbnailCache::scaleDown(const QString &name)
+{
+    const auto &download = m_downloads[name];
+    const QString largestName = entryName(download.videoId, SIZE_BUCKETS.back());
+    touch(largestName);
+
+    auto future = QtConcurrent::run(&m_imagePool, [this, bucket = download.bucket, name, largestName]() {
+        return write(name, squareThumbnail(image(largestName), bucket));
+    });
+
+    QCoro::connect(std::move(future), this, [this, name](qint64 size) {
+        if (size >= 0) {
+            insert(name, size);
+        }
+        finishDownload(name, size >= 0);
+    });
+}
+
+void ThumbnailCache::finishDownload(const QString &name, bool stored)
+{
+    auto download = m_downloads.take(name);
+    if (download.state == Download::Downloading) {
+        m_running--;
+    }
+
+    download.result.reportResult(stored ? name : QString());
+    download.result.reportFinished();
+}
+
+bool ThumbnailCache::touch(const QString &name)
+{
+    auto it = m_index.find(name);
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    it->lastAccess = QDateTime::currentSecsSinceEpoch();
+    m_saveTimer.start();
+    return true;
+}
+
+void ThumbnailCache::evict()
+{
+    if (m_totalSize <= m_budget) {
+        return;
+    }
+
+    const auto target = qint64(double(m_budget) * EVICTION_TARGET);
+    const QStringList names = leastRecentlyUsed(m_index, target, [this](const QString &name) {
+        // May still be read to create a smaller size
+        const QString videoId = name.left(name.lastIndexOf(QLatin1Char('@')));
+        return std::ranges::any_of(SIZE_BUCKETS, [&](int bucket) { return m_downloads.contains(entryName(videoId, bucket)); });
+    });
+
+    // Entries are removed from the index right away, so they are downloaded again if needed while the pack is compacted
+    for (const auto &name : names) {
+        m_totalSize -= m_index.take(name).size;
+    }
+
+    qDebug() << "Evicting" << names.size() << "thumbnails from the cache";
+
+    // The entries may be downloaded and appended again before this runs, which must not remove them
+    m_imagePool.start([this, names = std::move(names), revision = m_pack.revision()] {
+        m_pack.remove(names, revision);
+        m_pack.compact();
+    });
+    m_saveTimer.start();
+}
+
+QStringList ThumbnailCache::leastRecentlyUsed(const QHash<QString, Entry> &index, qint64 target, const std::function<bool(const QString &)> &keep)
+{
+    qint64 totalSize = 0;
+    std::vector<std::pair<qint64, QString>> byAccess;
+    byAccess.reserve(index.size());
+    for (auto it = index.begin(); it != index.end(); it++) {
+        totalSize += it->size;
+        byAccess.emplace_back(it->lastAccess, it.key());
+    }
+    std::ranges::sort(byAccess);
+
+    QStringList names;
+    for (const auto &[lastAccess, name] : byAccess) {
+        if (totalSize <= target) {
+            break;
+        }
+        if (keep(name)) {
+            continue;
+        }
+
+        totalSize -= index.value(name).size;
+        names.push_back(name);
+    }
+    return names;
+}
+
+void ThumbnailCache::saveIndex()
+{
+    m_imagePool.start([this, index = m_index] {
+        writeIndex(m_directory, index);
+        m_pack.saveIndex();
+    });
+}
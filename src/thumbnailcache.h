@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "thumbnailpack.h"
+
+#include <array>
+#include <functional>
+#include <map>
+#include <vector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+///
+/// Cache of downloaded thumbnails and rendered playlist covers, stored in a ThumbnailPack in the cache directory.
+///
+/// The directory is created, migrated and indexed once on a worker thread, when the cache is first used.
+/// Afterwards, looking up an entry only checks an in-memory index, without touching the file system.
+/// The time each entry was last used is stored in the directory as well.
+///
+/// Once the entries take up more space than the budget, the least recently used ones are removed in the background.
+/// The budget can be set in MiB with the AUDIOTUBE_THUMBNAIL_CACHE_SIZE environment variable.
+///
+/// Thumbnails are stored in a few sizes, so small views don't need to decode large images,
+/// while large views still get a sharp image. All sizes are generated from the largest one, so they only need one download.
+///
+/// Missing thumbnails are downloaded by a bounded number of concurrent requests.
+/// The most recently requested thumbnails are downloaded first, as they most likely belong to delegates that are on screen,
+/// and requests that nobody waits for anymore are dropped. Images are scaled in a thread pool reserved for that.
+///
+/// Must only be used from the GUI thread.
+///
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        qint64 size = 0;
+        // Seconds since the epoch
+        qint64 lastAccess = 0;
+    };
+
+    /// Edge lengths in logical pixels, in which thumbnails are stored
+    static constexpr std::array SIZE_BUCKETS = { 64, 200, 600 };
+
+    static ThumbnailCache &instance();
+
+    /// Creates a cache in the directory, which downloads thumbnails with nam.
+    /// The application uses instance(), this is for benchmarks.
+    ThumbnailCache(const QString &directory, QNetworkAccessManager &nam);
+
+    /// Name of the entry of a video thumbnail, which is at least size logical pixels large
+    static QString entryName(const QString &videoId, int size);
+
+    /// Returns the entry name of the cached thumbnail of a video, after downloading it if it is not cached yet.
+    /// It is the smallest stored size which is at least size logical pixels large, or the largest one.
+    /// The name is empty if the thumbnail could not be downloaded, or if it was released.
+    /// Callers that are no longer interested in the thumbnail before the future finished need to call release().
+    QFuture<QString> thumbnail(const QString &videoId, int size);
+    /// Gives up one request made with thumbnail(). The download is dropped once all of its requests are released.
+    void release(const QString &videoId, int size);
+
+    /// Returns the name of the entry, or an empty string if it is not cached
+    QFuture<QString> lookup(const QString &name);
+    /// Adds an entry of the given size in bytes to the index, after it has been written with write()
+    void insert(const QString &name, qint64 size);
+
+    /// Encodes the image and stores it under the name. Can be called from any thread.
+    /// Returns the size of the stored entry, or -1 if it could not be written.
+    qint64 write(const QString &name, const QImage &image);
+    /// Decodes a stored entry. Can be called from any thread.
+    QImage image(const QString &name) const;
+
+    /// Thread pool for decoding, scaling and encoding thumbnails
+    QThreadPool *imagePool();
+
+    /// Selects the least recently used entries to remove, until the remaining ones take up at most target bytes.
+    /// Entries for which keep returns true are skipped.
+    static QStringList leastRecentlyUsed(const QHash<QString, Entry> &index, qint64 target, const std::function<bool(const QString &)> &keep);
+
+private:
+    struct Download {
+        enum State {
+            Queued,
+            Downloading,
+            Scaling,
+        };
+
+        QString videoId;
+        int bucket = 0;
+        QFutureInterface<QString> result;
+        int waiters = 0;
+        State state = Queued;
+        // Key in m_queue while the download is queued
+        quint64 queuePosition = 0;
+        QPointer<QNetworkReply> reply;
+    };
+
+    /// Runs the function once the index is loaded
+    void whenLoaded(std::function<void()> &&function);
+    /// Starts queued downloads, as long as there are free slots
+    void startDownloads();
+    void fetch(const QString &name);
+    void store(const QString &name, QNetworkReply *reply);
+    /// Creates the entry from the largest stored size of the thumbnail
+    void scaleDown(const QString &name);
+    void finishDownload(const QString &name, bool stored);
+
+    /// Marks the entry as used now, if it exists
+    bool touch(const QString &name);
+    /// Removes the least recently used entries, until they fit into the budget again
+    void evict();
+    /// Writes the index in the background
+    void saveIndex();
+
+    QString m_directory;
+    QNetworkAccessManager &m_nam;
+    bool m_loaded = false;
+    std::vector<std::function<void()>> m_waitingForIndex;
+    QHash<QString, Entry> m_index;
+    qint64 m_totalSize = 0;
+    qint64 m_budget;
+    // Delays writing the index, so it isn't written for each change
+    QTimer m_saveTimer;
+    ThumbnailPack m_pack;
+
+    // By entry name
+    QHash<QString, Download> m_downloads;
+    // Entry names of queued downloads, in the order they were requested
+    std::map<quint64, QString> m_queue;
+    quint64 m_requests = 0;
+    int m_running = 0;
+
+    QThreadPool m_imagePool;
+};
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "thumbnailimageprovider.h"
+
+#include <QDebug>
+#include <QStringBuilder>
+#include <QThreadPool>
+#include <QUrl>
+
+#include "thumbnailcache.h"
+
+namespace {
+
+// Enough for a few hundred thumbnails at 200 pixels on a display with a device pixel ratio of two
+constexpr qsizetype MEMORY_BUDGET_BYTES = 64 * 1024 * 1024;
+
+class ThumbnailImageResponse : public QQuickImageResponse
+{
+public:
+    QQuickTextureFactory *textureFactory() const override {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override {
+        return m_errorString;
+    }
+
+    /// Can be called from any thread
+    void finish(const QImage &image, const QString &name) {
+        m_image = image;
+        if (image.isNull()) {
+            m_errorString = u"Thumbnail " % name % u" could not be loaded";
+        }
+        Q_EMIT finished();
+    }
+
+private:
+    QImage m_image;
+    QString m_errorString;
+};
+
+}
+
+ThumbnailImageProvider::ThumbnailImageProvider()
+    : m_state(std::make_shared<State>())
+{
+    m_state->images.setMaxCost(MEMORY_BUDGET_BYTES);
+    m_state->statistics.budgetBytes = MEMORY_BUDGET_BYTES;
+}
+
+ThumbnailImageProvider::~ThumbnailImageProvider()
+{
+    if (qEnvironmentVariableIsSet("AUDIOTUBE_THUMBNAIL_STATISTICS")) {
+        const auto stats = statistics();
+        qDebug().nospace() << "Thumbnail memory cache: " << stats.usedBytes / 1024 << " KiB of " << stats.budgetBytes / 1024 << " KiB used, "
+                           << stats.hits << " hits, " << stats.misses << " misses, " << stats.decodes << " decodes";
+    }
+}
+
+QQuickImageResponse *ThumbnailImageProvider::requestImageResponse(const QString &id, const QSize &)
+{
+    auto *response = new ThumbnailImageResponse();
+    ThumbnailCache::instance().imagePool()->start([state = m_state, response, id]() {
+        response->finish(state->image(id), id);
+    });
+    return response;
+}
+
+QUrl ThumbnailImageProvider::url(const QString &name)
+{
+    return QUrl(u"image://" % QLatin1String(PROVIDER_ID) % u'/' % name);
+}
+
+ThumbnailMemoryStatistics ThumbnailImageProvider::statistics() const
+{
+    std::scoped_lock lock(m_state->mutex);
+    auto statistics = m_state->statistics;
+    statistics.usedBytes = m_state->images.totalCost();
+    return statistics;
+}
+
+QImage ThumbnailImageProvider::State::image(const QString &name)
+{
+    {
+        std::scoped_lock lock(mutex);
+        if (const auto *image = images.object(name)) {
+            statistics.hits++;
+            return *image;
+        }
+        statistics.misses++;
+    }
+
+    // Decode without holding the lock, so other requests aren't blocked by it
+    QImage image = ThumbnailCache::instance().image(name);
+    if (image.isNull()) {
+        return image;
+    }
+
+    std::scoped_lock lock(mutex);
+    statistics.decodes++;
+    images.insert(name, new QImage(image), image.sizeInBytes());
+    return image;
+}
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QQuickAsyncImageProvider>
+
+#include <memory>
+#include <mutex>
+
+struct ThumbnailMemoryStatistics {
+    qsizetype usedBytes = 0;
+    qsizetype budgetBytes = 0;
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 decodes = 0;
+};
+
+///
+/// Provides the entries of the ThumbnailCache to QML as image://thumbnail/<name>.
+///
+/// Decoded images are kept in memory up to a budget in bytes, dropping the least recently used ones first,
+/// so a cover that is shown in several views is only read and decoded once.
+/// If the AUDIOTUBE_THUMBNAIL_STATISTICS environment variable is set, its statistics are printed when it is destroyed.
+///
+class ThumbnailImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    static constexpr auto PROVIDER_ID = "thumbnail";
+
+    ThumbnailImageProvider();
+    ~ThumbnailImageProvider() override;
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    /// URL under which the provider serves the cache entry with the name
+    static QUrl url(const QString &name);
+
+    ThumbnailMemoryStatistics statistics() const;
+
+private:
+    /// Shared with running requests, which may outlive the provider
+    struct State {
+        QImage image(const QString &name);
+
+        mutable std::mutex mutex;
+        QCache<QString, QImage> images;
+        ThumbnailMemoryStatistics statistics;
+    };
+
+    std::shared_ptr<State> m_state;
+};
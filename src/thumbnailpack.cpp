@@ -0,0 +1,402 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "thumbnailpack.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QStringBuilder>
+#include <QtEndian>
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr QLatin1String PACK_FILE("/thumbnails.pack");
+constexpr QLatin1String INDEX_FILE("/thumbnails.pack.index");
+
+constexpr quint32 PACK_MAGIC = 0x4154504b; // ATPK
+constexpr quint32 RECORD_MAGIC = 0x41545243; // ATRC
+constexpr quint32 INDEX_MAGIC = 0x41545058; // ATPX
+constexpr quint16 FORMAT_VERSION = 1;
+
+// Magic, format version, padding and generation
+constexpr qint64 PACK_HEADER_SIZE = 4 + 2 + 2 + 8;
+// Magic, checksum of the data, size of the name and size of the data
+constexpr qint64 RECORD_HEADER_SIZE = 4 + 2 + 2 + 4;
+
+// Compacting rewrites the whole pack, so only do it once a quarter of it is unused
+constexpr qint64 COMPACTION_RATIO = 4;
+// The file grows by this much more than needed when a record doesn't fit anymore.
+// Replacing the mapping blocks all readers, so it should happen only every few hundred thumbnails.
+constexpr qint64 GROWTH_BYTES = 4 * 1024 * 1024;
+
+struct Record {
+    QString name;
+    QByteArrayView data;
+    qint64 size = 0;
+};
+
+///
+/// Reads the record at the offset, if it is complete and its data matches its checksum
+///
+std::optional<Record> readRecord(const uchar *map, qint64 fileSize, qint64 offset)
+{
+    if (!map || offset + RECORD_HEADER_SIZE > fileSize) {
+        return std::nullopt;
+    }
+
+    const uchar *header = map + offset;
+    if (qFromBigEndian<quint32>(header) != RECORD_MAGIC) {
+        return std::nullopt;
+    }
+    const auto checksum = qFromBigEndian<quint16>(header + 4);
+    const auto nameSize = qFromBigEndian<quint16>(header + 6);
+    const auto dataSize = qFromBigEndian<quint32>(header + 8);
+
+    const qint64 size = RECORD_HEADER_SIZE + nameSize + dataSize;
+    if (offset + size > fileSize) {
+        return std::nullopt;
+    }
+
+    const auto *name = reinterpret_cast<const char *>(header + RECORD_HEADER_SIZE);
+    const QByteArrayView data(name + nameSize, dataSize);
+    if (qChecksum(data) != checksum) {
+        return std::nullopt;
+    }
+
+    return Record { QString::fromUtf8(name, nameSize), data, size };
+}
+
+QByteArray packHeader(quint64 generation)
+{
+    QByteArray header(PACK_HEADER_SIZE, '\0');
+    auto *data = reinterpret_cast<uchar *>(header.data());
+    qToBigEndian(PACK_MAGIC, data);
+    qToBigEndian(FORMAT_VERSION, data + 4);
+    qToBigEndian(generation, data + 8);
+    return header;
+}
+
+}
+
+ThumbnailPack::ThumbnailPack(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+ThumbnailPack::~ThumbnailPack() = default;
+
+QHash<QString, qint64> ThumbnailPack::open()
+{
+    std::unique_lock lock(m_mutex);
+
+    m_file.setFileName(m_directory % PACK_FILE);
+    if (!m_file.open(QFile::ReadWrite | QFile::Unbuffered)) {
+        qWarning() << "Failed to open thumbnail pack" << m_file.errorString();
+        return {};
+    }
+
+    QByteArray header = m_file.read(PACK_HEADER_SIZE);
+    const auto *data = reinterpret_cast<const uchar *>(header.constData());
+    if (header.size() != PACK_HEADER_SIZE || qFromBigEndian<quint32>(data) != PACK_MAGIC
+        || qFromBigEndian<quint16>(data + 4) != FORMAT_VERSION) {
+        if (!create()) {
+            return {};
+        }
+    } else {
+        m_generation = qFromBigEndian<quint64>(data + 8);
+    }
+
+    if (!readIndex()) {
+        m_locations.clear();
+        m_end = PACK_HEADER_SIZE;
+    }
+
+    qint64 used = 0;
+    for (const auto &location : std::as_const(m_locations)) {
+        used += location.size;
+    }
+    m_garbage = m_end - PACK_HEADER_SIZE - used;
+
+    remap();
+    recover();
+
+    QHash<QString, qint64> sizes;
+    sizes.reserve(m_locations.size());
+    for (auto it = m_locations.begin(); it != m_locations.end(); it++) {
+        sizes.insert(it.key(), it->size);
+    }
+    return sizes;
+}
+
+void ThumbnailPack::clear(const QString &directory)
+{
+    QFile::remove(directory % PACK_FILE);
+    QFile::remove(directory % INDEX_FILE);
+}
+
+qint64 ThumbnailPack::append(const QString &name, QByteArrayView data)
+{
+    const QByteArray utf8Name = name.toUtf8();
+
+    QByteArray record(RECORD_HEADER_SIZE, '\0');
+    auto *header = reinterpret_cast<uchar *>(record.data());
+    qToBigEndian(RECORD_MAGIC, header);
+    qToBigEndian(qChecksum(data), header + 4);
+    qToBigEndian(quint16(utf8Name.size()), header + 6);
+    qToBigEndian(quint32(data.size()), header + 8);
+    record.append(utf8Name);
+    record.append(data);
+
+    std::unique_lock lock(m_mutex);
+    if (!m_file.isOpen()) {
+        return -1;
+    }
+
+    // Readers only use the mapping up to the end of the last record, so it only needs to be replaced once the file grows
+    if (m_end + record.size() > m_mapped) {
+        if (m_map) {
+            m_file.unmap(m_map);
+            m_map = nullptr;
+        }
+        if (!m_file.resize(m_end + record.size() + GROWTH_BYTES)) {
+            qWarning() << "Failed to grow thumbnail pack" << m_file.errorString();
+        }
+        remap();
+        if (m_end + record.size() > m_mapped) {
+            return -1;
+        }
+    }
+
+    // A record that was written only partially is overwritten by the next one, or cut off when the pack is opened the next time
+    if (!m_file.seek(m_end) || m_file.write(record) != record.size() || !m_file.flush()) {
+        qWarning() << "Failed to append to thumbnail pack" << m_file.errorString();
+        return -1;
+    }
+
+    if (const auto previous = m_locations.value(name); previous.size > 0) {
+        m_garbage += previous.size;
+    }
+    m_locations.insert(name, Location { m_end, record.size(), ++m_revision });
+    m_end += record.size();
+
+    return record.size();
+}
+
+QImage ThumbnailPack::image(const QString &name) const
+{
+    std::shared_lock lock(m_mutex);
+
+    const auto it = m_locations.constFind(name);
+    if (it == m_locations.cend()) {
+        return {};
+    }
+
+    const auto record = readRecord(m_map, m_end, it->offset);
+    if (!record) {
+        qWarning() << "Thumbnail" << name << "is corrupted";
+        return {};
+    }
+
+    // Decodes directly from the mapping, without copying the data
+    return QImage::fromData(record->data);
+}
+
+quint64 ThumbnailPack::revision() const
+{
+    return m_revision;
+}
+
+void ThumbnailPack::remove(const QStringList &names, quint64 revision)
+{
+    std::unique_lock lock(m_mutex);
+    for (const auto &name : names) {
+        if (const auto it = m_locations.constFind(name); it != m_locations.cend() && it->revision <= revision) {
+            m_garbage += it->size;
+            m_locations.erase(it);
+        }
+    }
+}
+
+void ThumbnailPack::saveIndex() const
+{
+    std::shared_lock lock(m_mutex);
+    writeIndex();
+}
+
+void ThumbnailPack::compact()
+{
+    // Held until the new pack is mapped and indexed, so no append can land in the old file while it is replaced
+    std::unique_lock lock(m_mutex);
+    if (!m_map || m_garbage * COMPACTION_RATIO < m_end) {
+        return;
+    }
+
+    qDebug() << "Compacting thumbnail pack," << m_garbage / 1024 << "KiB unused of" << m_end / 1024 << "KiB";
+
+    // Keep the order of the records, so reading neighbouring thumbnails stays local
+    std::vector<std::pair<QString, Location>> records;
+    records.reserve(m_locations.size());
+    for (auto it = m_locations.begin(); it != m_locations.end(); it++) {
+        records.emplace_back(it.key(), *it);
+    }
+    std::ranges::sort(records, std::less(), [](const auto &record) { return record.second.offset; });
+
+    // Replaces the pack only once it is completely written.
+    // A new generation makes sure the old index is not used for it, if writing the new one is interrupted.
+    const quint64 generation = QRandomGenerator::system()->generate64();
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QFile::WriteOnly)) {
+        return;
+    }
+    file.write(packHeader(generation));
+
+    QHash<QString, Location> locations;
+    locations.reserve(qsizetype(records.size()));
+    qint64 end = PACK_HEADER_SIZE;
+    for (const auto &[name, location] : records) {
+        file.write(reinterpret_cast<const char *>(m_map + location.offset), location.size);
+        locations.insert(name, Location { end, location.size, location.revision });
+        end += location.size;
+    }
+
+    // The old file has to be closed before it can be replaced on all platforms
+    m_file.unmap(m_map);
+    m_map = nullptr;
+    m_file.close();
+
+    if (file.commit()) {
+        m_locations = std::move(locations);
+        m_generation = generation;
+        m_end = end;
+        m_garbage = 0;
+    } else {
+        qWarning() << "Failed to compact thumbnail pack" << file.errorString();
+    }
+
+    if (!m_file.open(QFile::ReadWrite | QFile::Unbuffered)) {
+        qWarning() << "Failed to open thumbnail pack" << m_file.errorString();
+        m_locations.clear();
+        return;
+    }
+    remap();
+    writeIndex();
+}
+
+bool ThumbnailPack::create()
+{
+    m_generation = QRandomGenerator::system()->generate64();
+    if (!m_file.resize(0) || !m_file.seek(0) || m_file.write(packHeader(m_generation)) != PACK_HEADER_SIZE) {
+        qWarning() << "Failed to create thumbnail pack" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_file.flush();
+    return true;
+}
+
+void ThumbnailPack::remap()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+    m_mapped = m_file.size();
+    m_map = m_file.map(0, m_mapped);
+    if (!m_map) {
+        qWarning() << "Failed to map thumbnail pack" << m_file.errorString();
+        m_mapped = 0;
+    }
+}
+
+void ThumbnailPack::recover()
+{
+    const qint64 fileSize = m_file.size();
+
+    int recovered = 0;
+    while (const auto record = readRecord(m_map, fileSize, m_end)) {
+        if (const auto previous = m_locations.value(record->name); previous.size > 0) {
+            m_garbage += previous.size;
+        }
+        m_locations.insert(record->name, Location { m_end, record->size });
+        m_end += record->size;
+        recovered++;
+    }
+
+    if (recovered > 0) {
+        qDebug() << "Recovered" << recovered << "thumbnails that were not in the index";
+    }
+
+    // Also cuts off the space the file grew by in advance. It is not worth keeping,
+    // as old records in it could otherwise be recovered later, once new ones end right before them.
+    if (m_end < fileSize) {
+        const auto *rest = m_map ? m_map + m_end : nullptr;
+        if (rest && !std::all_of(rest, m_map + fileSize, [](uchar byte) { return byte == 0; })) {
+            qDebug() << "Cutting off" << fileSize - m_end << "bytes of incomplete thumbnails";
+        }
+        m_file.resize(m_end);
+        remap();
+    }
+}
+
+bool ThumbnailPack::readIndex()
+{
+    QFile file(m_directory % INDEX_FILE);
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint64 generation = 0;
+    qint64 end = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> generation >> end >> count;
+    // An index of a different pack, for example from before it was compacted, can't be used
+    if (magic != INDEX_MAGIC || version != FORMAT_VERSION || generation != m_generation
+        || end < PACK_HEADER_SIZE || end > m_file.size() || count < 0) {
+        return false;
+    }
+
+    m_locations.clear();
+    m_locations.reserve(count);
+    for (qint32 i = 0; i < count; i++) {
+        QString name;
+        Location location;
+        stream >> name >> location.offset >> location.size;
+        m_locations.insert(name, location);
+    }
+    m_end = end;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+void ThumbnailPack::writeIndex() const
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    QSaveFile file(m_directory % INDEX_FILE);
+    if (!file.open(QFile::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << INDEX_MAGIC << FORMAT_VERSION << m_generation << m_end << qint32(m_locations.size());
+    for (auto it = m_locations.begin(); it != m_locations.end(); it++) {
+        stream << it.key() << it->offset << it->size;
+    }
+    file.commit();
+}
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <limits>
+#include <shared_mutex>
+
+///
+/// Stores many small images in one append-only file, so reading one of them doesn't need to open a file,
+/// and the cache directory doesn't contain a file for each of them.
+///
+/// Every record carries its name and a checksum of its data. Records that were appended after the index was last saved
+/// are recovered when the pack is opened, and a record that was only partially written before a crash is cut off.
+/// Removed records stay in the file until it is compacted.
+///
+/// The file is memory-mapped, and images are decoded directly from the mapping.
+/// It grows in large steps, so the mapping rarely needs to be replaced.
+/// All methods can be called from any thread.
+///
+class ThumbnailPack
+{
+public:
+    explicit ThumbnailPack(const QString &directory);
+    ~ThumbnailPack();
+
+    /// Opens the pack, or creates it if it doesn't exist yet. Returns the size of each record by name.
+    QHash<QString, qint64> open();
+    /// Deletes the pack and its index from the directory
+    static void clear(const QString &directory);
+
+    /// Adds a record, which replaces an earlier one with the same name.
+    /// Returns the size of the record, or -1 if it could not be written.
+    qint64 append(const QString &name, QByteArrayView data);
+    /// Decodes the image stored under the name, or returns a null image if there is none
+    QImage image(const QString &name) const;
+    /// Counts the appended records. Doesn't wait for other threads using the pack.
+    quint64 revision() const;
+    /// Removes the records, unless they were appended after the given revision.
+    /// This way, a record that was removed and written again while the removal was queued is kept.
+    void remove(const QStringList &names, quint64 revision = std::numeric_limits<quint64>::max());
+
+    /// Writes the index, so the records don't need to be scanned the next time the pack is opened
+    void saveIndex() const;
+    /// Rewrites the pack without the removed records, once they take up a considerable part of it.
+    /// Blocks all other access to the pack until it is done.
+    void compact();
+
+private:
+    struct Location {
+        qint64 offset = 0;
+        // Including the record header
+        qint64 size = 0;
+        // Revision in which it was appended, or 0 if it was there when the pack was opened
+        quint64 revision = 0;
+    };
+
+    /// Creates an empty pack
+    bool create();
+    /// Maps the whole file again, after it changed its size
+    void remap();
+    /// Adds the valid records after the indexed ones, and cuts off the rest of the file
+    void recover();
+    bool readIndex();
+    void writeIndex() const;
+
+    QString m_directory;
+    QFile m_file;
+    uchar *m_map = nullptr;
+    // Size of the mapping, which includes the space the file grew by in advance
+    qint64 m_mapped = 0;
+    quint64 m_generation = 0;
+    // End of the last valid record
+    qint64 m_end = 0;
+    // Bytes taken up by removed or replaced records
+    qint64 m_garbage = 0;
+    QHash<QString, Location> m_locations;
+    // Only changed while holding the mutex exclusively
+    std::atomic<quint64> m_revision = 0;
+
+    mutable std::shared_mutex m_mutex;
+};
@@ -5,21 +5,33 @@
 #pragma once
 
 #include <QObject>
+#include <QQmlParserStatus>
 #include <QUrl>
 
-class ThumbnailSource : public QObject {
+class ThumbnailSource : public QObject, public QQmlParserStatus {
     Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
 
     Q_PROPERTY(QString videoId READ videoId WRITE setVideoId NOTIFY videoIdChanged)
+    /// Size in logical pixels at which the thumbnail is shown. The cache provides the smallest stored size that fits.
+    Q_PROPERTY(int size READ size WRITE setSize NOTIFY sizeChanged)
     Q_PROPERTY(QUrl cachedPath READ cachedPath NOTIFY cachedPathChanged)
 
 public:
+    ~ThumbnailSource() override;
+
     QString videoId() const {
         return m_videoId;
     }
     void setVideoId(const QString &id);
     Q_SIGNAL void videoIdChanged();
 
+    int size() const {
+        return m_size;
+    }
+    void setSize(int size);
+    Q_SIGNAL void sizeChanged();
+
     QUrl cachedPath() const {
         return m_cachedPath;
     }
@@ -29,7 +41,20 @@ public:
     }
     Q_SIGNAL void cachedPathChanged();
 
+    void classBegin() override {}
+    void componentComplete() override;
+
 private:
+    /// Requests the thumbnail for the current video id and size
+    void update();
+    /// Tells the cache that the requested thumbnail isn't needed anymore, if it didn't arrive yet
+    void releasePending();
+
     QString m_videoId;
+    int m_size = 200;
+    // Only request a thumbnail once all properties are set
+    bool m_complete = false;
+    QString m_pendingId;
+    int m_pendingSize = 0;
     QUrl m_cachedPath;
 };
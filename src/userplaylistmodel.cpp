@@ -19,9 +19,19 @@
 #include "localplaylistmodel.h"
 #include "playlistutils.h"
 #include "playlistmodel.h"
+#include "thumbnailcache.h"
 
 namespace ranges = std::ranges;
 
+using namespace std::chrono_literals;
+
+// Number of upcoming tracks that are resolved in advance
+constexpr int PREFETCH_COUNT = 2;
+// Wait a bit after the queue changed, so the current track is resolved first
+constexpr auto PREFETCH_DELAY = 3s;
+// Size in which PlayerFooter and the maximized player show the current track
+constexpr int PREFETCH_THUMBNAIL_SIZE = 600;
+
 UserPlaylistModel::UserPlaylistModel(QObject *parent)
     : AbstractYTMusicModel(parent)
 {
@@ -73,6 +83,32 @@ UserPlaylistModel::UserPlaylistModel(QObject *parent)
             fetchLyrics(m_currentVideoId);
         }
     });
+
+    // Skipping and editing the queue change the upcoming tracks
+    m_prefetchTimer.setSingleShot(true);
+    m_prefetchTimer.setInterval(PREFETCH_DELAY);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, &UserPlaylistModel::prefetchUpcoming);
+    auto schedulePrefetch = [this] {
+        m_prefetchTimer.start();
+    };
+    connect(this, &UserPlaylistModel::currentVideoIdChanged, this, schedulePrefetch);
+    connect(this, &UserPlaylistModel::rowsInserted, this, schedulePrefetch);
+    connect(this, &UserPlaylistModel::rowsRemoved, this, schedulePrefetch);
+    connect(this, &UserPlaylistModel::rowsMoved, this, schedulePrefetch);
+    connect(this, &UserPlaylistModel::modelReset, this, schedulePrefetch);
+    connect(this, &UserPlaylistModel::dataChanged, this, schedulePrefetch);
+}
+
+UserPlaylistModel::~UserPlaylistModel()
+{
+    for (auto &videoInfo : m_prefetchedVideoInfos) {
+        videoInfo.cancel();
+    }
+    for (const auto &[videoId, thumbnail] : m_prefetchedThumbnails) {
+        if (!thumbnail.isFinished()) {
+            ThumbnailCache::instance().release(videoId, PREFETCH_THUMBNAIL_SIZE);
+        }
+    }
 }
 
 int UserPlaylistModel::rowCount(const QModelIndex &parent) const
@@ -486,6 +522,57 @@ void UserPlaylistModel::fetchLyrics(const QString &videoId)
     });
 }
 
+void UserPlaylistModel::prefetchUpcoming()
+{
+    QStringList upcoming;
+
+    auto trackIt = ranges::find_if(m_playlist.tracks, [this](const watch::Playlist::Track &track) {
+        return track.video_id == m_currentVideoId.toStdString();
+    });
+    if (trackIt != m_playlist.tracks.end()) {
+        for (++trackIt; trackIt != m_playlist.tracks.end() && upcoming.size() < PREFETCH_COUNT; ++trackIt) {
+            upcoming.push_back(QString::fromStdString(trackIt->video_id));
+        }
+    }
+
+    if (upcoming == m_prefetchedVideoIds) {
+        return;
+    }
+
+    // Drop the results for tracks that are no longer coming up next
+    m_prefetchedVideoInfos.removeIf([&](auto it) {
+        if (upcoming.contains(it.key())) {
+            return false;
+        }
+        it.value().cancel();
+        return true;
+    });
+    std::erase_if(m_prefetchedThumbnails, [&](const auto &thumbnail) {
+        const auto &[videoId, future] = thumbnail;
+        if (upcoming.contains(videoId)) {
+            return false;
+        }
+        if (!future.isFinished()) {
+            ThumbnailCache::instance().release(videoId, PREFETCH_THUMBNAIL_SIZE);
+        }
+        return true;
+    });
+
+    for (const auto &videoId : std::as_const(upcoming)) {
+        if (m_prefetchedVideoIds.contains(videoId)) {
+            continue;
+        }
+
+        // The result is kept in the stream cache of AsyncYTMusic, where VideoInfoExtractor finds it
+        m_prefetchedVideoInfos.insert(videoId, YTMusicThread::instance()->extractVideoInfo(videoId));
+
+        // Only downloaded and stored in the cache, where the player finds it once the track starts
+        m_prefetchedThumbnails.emplace_back(videoId, ThumbnailCache::instance().thumbnail(videoId, PREFETCH_THUMBNAIL_SIZE));
+    }
+
+    m_prefetchedVideoIds = upcoming;
+}
+
 bool UserPlaylistModel::shuffle() const
 {
     return m_shuffle;
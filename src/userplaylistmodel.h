@@ -3,6 +3,10 @@
 // SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #pragma once
 
+#include <QFuture>
+#include <QHash>
+#include <QTimer>
+
 #include <ytmusic.h>
 
 #include "abstractytmusicmodel.h"
@@ -41,6 +45,7 @@ public:
     Q_ENUM(Role);
 
     explicit UserPlaylistModel(QObject *parent = nullptr);
+    ~UserPlaylistModel() override;
 
     int rowCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
@@ -107,6 +112,10 @@ private:
 
     void fetchLyrics(const QString &videoId);
 
+    /// Resolves the streams and thumbnails of the next tracks in the background,
+    /// so they can start playing without waiting for yt-dlp.
+    void prefetchUpcoming();
+
     QString m_initialVideoId;
     QString m_playlistId;
     QString m_currentVideoId;
@@ -114,4 +123,11 @@ private:
 
     watch::Playlist m_playlist;
     ::Lyrics m_lyrics;
+
+    QTimer m_prefetchTimer;
+    QStringList m_prefetchedVideoIds;
+    // Canceled once the track is no longer coming up next, so yt-dlp doesn't keep a worker busy for it
+    QHash<QString, QFuture<video_info::VideoInfo>> m_prefetchedVideoInfos;
+    // Requested from ThumbnailCache, by video id
+    std::vector<std::pair<QString, QFuture<QString>>> m_prefetchedThumbnails;
 };
@@ -7,6 +7,7 @@
 #include <QFutureWatcher>
 
 #include "asyncytmusic.h"
+#include "streamurlcache.h"
 
 VideoInfoExtractor::VideoInfoExtractor(QObject *parent)
     : QObject(parent)
@@ -20,39 +21,29 @@ VideoInfoExtractor::VideoInfoExtractor(QObject *parent)
 
         setLoading(true);
 
-        auto future = YTMusicThread::instance()->extractVideoInfo(QString::fromStdString(m_videoId.toStdString()));
-        QCoro::connect(std::move(future), this, [this](const video_info::VideoInfo &videoInfo) {
-            m_videoInfo = videoInfo;
-            setLoading(false);
-            Q_EMIT songChanged();
-        });
+        // The previous track was skipped before it could be loaded
+        m_extraction.cancel();
+        m_extraction.setFuture(YTMusicThread::instance()->extractVideoInfo(m_videoId));
+    });
+    connect(&m_extraction, &QFutureWatcher<video_info::VideoInfo>::finished, this, [this] {
+        if (m_extraction.isCanceled() || m_extraction.future().resultCount() == 0) {
+            return;
+        }
+
+        m_videoInfo = m_extraction.result();
+        setLoading(false);
+        Q_EMIT songChanged();
     });
 }
 
 QUrl VideoInfoExtractor::audioUrl() const
 {
-    if (m_videoInfo.formats.empty()) {
+    const auto format = StreamUrlCache::bestAudioFormat(m_videoInfo);
+    if (!format) {
         return {};
     }
 
-    std::vector<video_info::Format> audioFormats;
-
-    // filter audio only formats
-    std::copy_if(m_videoInfo.formats.begin(), m_videoInfo.formats.end(), std::back_inserter(audioFormats),
-        [](const video_info::Format &format) {
-        return format.acodec != "none" && format.vcodec == "none";
-    });
-
-    if (audioFormats.empty()) {
-        return {};
-    }
-
-    std::sort(audioFormats.begin(), audioFormats.end(),
-              [](const video_info::Format &a, const video_info::Format &b) {
-        return a.quality > b.quality;
-    });
-
-    return QUrl(QString::fromStdString(audioFormats.front().url));
+    return QUrl(QString::fromStdString(format->url));
 }
 
 QString VideoInfoExtractor::videoId() const
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <QFutureWatcher>
 #include <QObject>
 #include <QUrl>
 
@@ -49,4 +50,5 @@ private:
     bool m_loading = false;
     QString m_videoId;
     video_info::VideoInfo m_videoInfo;
+    QFutureWatcher<video_info::VideoInfo> m_extraction;
 };
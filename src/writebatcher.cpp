@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#include "writebatcher.h"
+
+#include <QCoreApplication>
+
+#include <QCoroFuture>
+#include <QCoroTask>
+
+#include "statementcache.h"
+
+#include <utility>
+
+WriteBatcher::WriteBatcher(StatementCache &statements, std::chrono::milliseconds window, QObject *parent)
+    : QObject(parent)
+    , m_statements(statements)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(window);
+    connect(&m_timer, &QTimer::timeout, this, &WriteBatcher::flush);
+
+    // Don't lose writes that are still waiting for the window to end
+    if (auto *app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, &WriteBatcher::flush);
+    }
+}
+
+QFuture<void> WriteBatcher::enqueue(const QString &sqlQuery, QVariantList &&arguments)
+{
+    if (m_pending.empty()) {
+        m_batch = QFutureInterface<void>();
+        m_batch.reportStarted();
+        m_timer.start();
+    }
+
+    m_pending.emplace_back(sqlQuery, std::move(arguments));
+    return m_batch.future();
+}
+
+void WriteBatcher::flush()
+{
+    m_timer.stop();
+    if (m_pending.empty()) {
+        return;
+    }
+
+    const auto future = m_statements.executeInTransaction(std::exchange(m_pending, {}));
+
+    QCoro::connect(QFuture(future), this, [batch = m_batch, future]() mutable {
+        // None of the statements were written
+        if (future.isCanceled()) {
+            batch.reportCanceled();
+        }
+        batch.reportFinished();
+    });
+}
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#pragma once
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QObject>
+#include <QTimer>
+#include <QVariant>
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+class StatementCache;
+
+///
+/// Collects write statements for a short time, and then executes all of them in one transaction
+/// using the prepared statements of a StatementCache. This avoids a separate round trip and fsync for each statement,
+/// when many writes happen at once, like while importing a playlist or when skipping through tracks.
+///
+/// Statements are executed in the order they were queued.
+///
+class WriteBatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WriteBatcher(StatementCache &statements, std::chrono::milliseconds window, QObject *parent = nullptr);
+
+    /// Queues a statement. The returned future finishes once the transaction containing it was committed,
+    /// and is canceled if the transaction failed.
+    template <typename ...Args>
+    QFuture<void> execute(const QString &sqlQuery, const Args &...args) {
+        return enqueue(sqlQuery, QVariantList { QVariant::fromValue(args)... });
+    }
+
+    /// Starts executing the queued statements right away, without waiting for the window to end
+    void flush();
+
+private:
+    QFuture<void> enqueue(const QString &sqlQuery, QVariantList &&arguments);
+
+    StatementCache &m_statements;
+    QTimer m_timer;
+    std::vector<std::pair<QString, QVariantList>> m_pending;
+    QFutureInterface<void> m_batch;
+};
@@ -3,9 +3,15 @@
 // SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "ytmusic.h"
+#include "ytmusicconversion.h"
 
 #include <algorithm>
+#include <charconv>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
 
 #include <pybind11/embed.h>
 #include <pybind11/stl.h>
@@ -26,8 +32,32 @@ void pyPrintPretty(py::handle obj) {
 #define UNEXPORT
 #endif
 
+///
+/// The embedded interpreter is shared by all YTMusic instances, which may live on different threads.
+/// The GIL is released right after initialization, so every call has to take it using py::gil_scoped_acquire.
+///
+/// The interpreter is intentionally never finalized, as other threads may still hold Python objects
+/// while the application shuts down.
+///
+void ensure_interpreter() {
+    static std::once_flag flag;
+    std::call_once(flag, [] {
+        py::initialize_interpreter();
+        PyEval_SaveThread();
+    });
+}
+
 struct UNEXPORT YTMusicPrivate {
-    py::scoped_interpreter guard {};
+    YTMusicPrivate() {
+        ensure_interpreter();
+    }
+
+    ~YTMusicPrivate() {
+        py::gil_scoped_acquire gil;
+        ytmusic = py::none();
+        ytdl = py::none();
+        ytmusicapi_module = py::module();
+    }
 
     std::optional<std::string> auth;
     std::optional<std::string> user;
@@ -68,203 +98,653 @@ struct UNEXPORT YTMusicPrivate {
 public:
     py::module ytmusicapi_module;
 
+    // Python thread id of the thread currently running a call, or 0. Only accessed while holding the GIL.
+    unsigned long running_thread = 0;
+    // Set by interrupt() while no call is running, so the next one doesn't start. Only accessed while holding the GIL.
+    bool interrupt_pending = false;
+
 private:
     py::object ytmusic = py::none();
     py::object ytdl = py::none();
 };
 
+///
+/// Takes the GIL for the duration of a YTMusic call,
+/// and records the calling thread so the call can be interrupted using YTMusic::interrupt().
+///
+class UNEXPORT CallScope {
+public:
+    explicit CallScope(YTMusicPrivate &d)
+        : m_d(d)
+    {
+        // The request was interrupted before it reached Python, for example while it waited for the GIL
+        if (std::exchange(m_d.interrupt_pending, false)) {
+            throw std::runtime_error("Interrupted before the call started");
+        }
+        m_d.running_thread = PyThread_get_thread_ident();
+    }
+
+    ~CallScope() {
+        // Drop an interruption that arrived after Python returned, so it doesn't hit the next call
+        PyThreadState_SetAsyncExc(m_d.running_thread, nullptr);
+        m_d.running_thread = 0;
+    }
+
+private:
+    py::gil_scoped_acquire m_gil;
+    YTMusicPrivate &m_d;
+};
+
+///
+/// Makes a YTMusic object answer its first request without continuation parameters from memory the second time it is sent,
+/// as long as it is alive. All other requests are sent as usual.
+///
+/// This relies on ytmusicapi sending its requests through _send_request, and passing continuations as additionalParams.
+/// Needs to be created while holding the GIL.
+///
+class UNEXPORT ReplayedFirstResponse {
+public:
+    explicit ReplayedFirstResponse(py::object ytmusic)
+        : m_ytmusic(std::move(ytmusic))
+        , m_send_request(m_ytmusic.attr("_send_request"))
+    {
+        m_ytmusic.attr("_send_request") = py::cpp_function([this](py::args args, py::kwargs kwargs) -> py::object {
+            if (args.size() > 2 || kwargs.contains("additionalParams")) {
+                return m_send_request(*args, **kwargs);
+            }
+
+            if (m_response.is_none()) {
+                m_response = m_send_request(*args, **kwargs);
+                return m_response;
+            }
+
+            return std::exchange(m_response, py::none());
+        });
+    }
+
+    ~ReplayedFirstResponse() {
+        // Falls back to the method of the class again
+        if (PyObject_DelAttrString(m_ytmusic.ptr(), "_send_request") != 0) {
+            PyErr_Clear();
+        }
+    }
+
+    ReplayedFirstResponse(const ReplayedFirstResponse &) = delete;
+    ReplayedFirstResponse &operator=(const ReplayedFirstResponse &) = delete;
+
+private:
+    py::object m_ytmusic;
+    py::object m_send_request;
+    py::object m_response = py::none();
+};
+
+namespace json {
+
+///
+/// Parsed JSON document. Objects keep their members in order, as they only have a few of them,
+/// which are faster to compare than to hash.
+///
+struct Value {
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<Value> array;
+    std::vector<std::pair<std::string, Value>> members;
+};
+
+class UNEXPORT Parser {
+public:
+    explicit Parser(std::string_view text)
+        : m_text(text)
+    {
+    }
+
+    Value parse() {
+        auto value = parse_value();
+        skip_whitespace();
+        if (m_pos != m_text.size()) {
+            fail("unexpected data after the document");
+        }
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const char *reason) const {
+        throw std::runtime_error("Invalid JSON at offset " + std::to_string(m_pos) + ": " + reason);
+    }
+
+    void skip_whitespace() {
+        while (m_pos < m_text.size()
+               && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r' || m_text[m_pos] == '\t')) {
+            m_pos++;
+        }
+    }
+
+    void expect(std::string_view literal) {
+        if (m_text.substr(m_pos, literal.size()) != literal) {
+            fail("unknown literal");
+        }
+        m_pos += literal.size();
+    }
+
+    Value parse_value() {
+        skip_whitespace();
+        if (m_pos >= m_text.size()) {
+            fail("unexpected end");
+        }
+
+        Value value;
+        switch (m_text[m_pos]) {
+        case '{':
+            value.type = Value::Type::Object;
+            parse_object(value.members);
+            break;
+        case '[':
+            value.type = Value::Type::Array;
+            parse_array(value.array);
+            break;
+        case '"':
+            value.type = Value::Type::String;
+            value.string = parse_string();
+            break;
+        case 't':
+            expect("true");
+            value.type = Value::Type::Bool;
+            value.boolean = true;
+            break;
+        case 'f':
+            expect("false");
+            value.type = Value::Type::Bool;
+            break;
+        case 'n':
+            expect("null");
+            break;
+        default:
+            value.type = Value::Type::Number;
+            value.number = parse_number();
+        }
+        return value;
+    }
+
+    void parse_object(std::vector<std::pair<std::string, Value>> &members) {
+        m_pos++; // {
+        skip_whitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == '}') {
+            m_pos++;
+            return;
+        }
+
+        while (true) {
+            skip_whitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != '"') {
+                fail("expected a key");
+            }
+            auto key = parse_string();
+
+            skip_whitespace();
+            if (m_pos >= m_text.size() || m_text[m_pos] != ':') {
+                fail("expected ':'");
+            }
+            m_pos++;
+
+            members.emplace_back(std::move(key), parse_value());
+
+            skip_whitespace();
+            if (m_pos < m_text.size() && m_text[m_pos] == ',') {
+                m_pos++;
+            } else if (m_pos < m_text.size() && m_text[m_pos] == '}') {
+                m_pos++;
+                return;
+            } else {
+                fail("expected ',' or '}'");
+            }
+        }
+    }
+
+    void parse_array(std::vector<Value> &items) {
+        m_pos++; // [
+        skip_whitespace();
+        if (m_pos < m_text.size() && m_text[m_pos] == ']') {
+            m_pos++;
+            return;
+        }
+
+        while (true) {
+            items.push_back(parse_value());
+
+            skip_whitespace();
+            if (m_pos < m_text.size() && m_text[m_pos] == ',') {
+                m_pos++;
+            } else if (m_pos < m_text.size() && m_text[m_pos] == ']') {
+                m_pos++;
+                return;
+            } else {
+                fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    std::string parse_string() {
+        m_pos++; // "
+        std::string output;
+
+        while (true) {
+            // Copy everything up to the next escape sequence or the end of the string at once
+            const auto end = m_text.find_first_of("\"\\", m_pos);
+            if (end == std::string_view::npos) {
+                fail("unterminated string");
+            }
+            output.append(m_text.substr(m_pos, end - m_pos));
+            m_pos = end + 1;
+
+            if (m_text[end] == '"') {
+                return output;
+            }
+
+            if (m_pos >= m_text.size()) {
+                fail("unterminated escape sequence");
+            }
+            switch (m_text[m_pos++]) {
+            case '"': output.push_back('"'); break;
+            case '\\': output.push_back('\\'); break;
+            case '/': output.push_back('/'); break;
+            case 'b': output.push_back('\b'); break;
+            case 'f': output.push_back('\f'); break;
+            case 'n': output.push_back('\n'); break;
+            case 'r': output.push_back('\r'); break;
+            case 't': output.push_back('\t'); break;
+            case 'u': append_code_point(output); break;
+            default: fail("unknown escape sequence");
+            }
+        }
+    }
+
+    uint32_t parse_hex4() {
+        if (m_pos + 4 > m_text.size()) {
+            fail("incomplete unicode escape");
+        }
+        uint32_t value = 0;
+        const auto [end, error] = std::from_chars(m_text.data() + m_pos, m_text.data() + m_pos + 4, value, 16);
+        if (error != std::errc() || end != m_text.data() + m_pos + 4) {
+            fail("invalid unicode escape");
+        }
+        m_pos += 4;
+        return value;
+    }
+
+    void append_code_point(std::string &output) {
+        uint32_t code_point = parse_hex4();
+
+        // Characters outside of the basic multilingual plane are escaped as surrogate pairs
+        if (code_point >= 0xD800 && code_point < 0xDC00
+            && m_text.substr(m_pos, 2) == "\\u") {
+            m_pos += 2;
+            const uint32_t low = parse_hex4();
+            if (low < 0xDC00 || low >= 0xE000) {
+                fail("invalid surrogate pair");
+            }
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (code_point < 0x80) {
+            output.push_back(char(code_point));
+        } else if (code_point < 0x800) {
+            output.push_back(char(0xC0 | (code_point >> 6)));
+            output.push_back(char(0x80 | (code_point & 0x3F)));
+        } else if (code_point < 0x10000) {
+            output.push_back(char(0xE0 | (code_point >> 12)));
+            output.push_back(char(0x80 | ((code_point >> 6) & 0x3F)));
+            output.push_back(char(0x80 | (code_point & 0x3F)));
+        } else {
+            output.push_back(char(0xF0 | (code_point >> 18)));
+            output.push_back(char(0x80 | ((code_point >> 12) & 0x3F)));
+            output.push_back(char(0x80 | ((code_point >> 6) & 0x3F)));
+            output.push_back(char(0x80 | (code_point & 0x3F)));
+        }
+    }
+
+    double parse_number() {
+        double value = 0;
+        const auto [end, error] = std::from_chars(m_text.data() + m_pos, m_text.data() + m_text.size(), value);
+        if (error != std::errc()) {
+            fail("invalid number");
+        }
+        m_pos = end - m_text.data();
+        return value;
+    }
+
+    std::string_view m_text;
+    size_t m_pos = 0;
+};
+
+Value parse(std::string_view text) {
+    return Parser(text).parse();
+}
+
+}
+
+///
+/// The extractors below are written once for both ways of converting results:
+/// walking the Python objects (py::handle), or walking a JSON document that was serialized in Python (const json::Value *).
+/// Both node types are nullable, and a null node means the key doesn't exist.
+///
+
+///
+/// Looks up a dict item without creating the temporary key and accessor objects of pybind11's obj["key"].
+/// Returns a null handle if the object is not a dict or doesn't contain the key.
+///
+inline py::handle dict_item(py::handle dict, const char *key) {
+    if (!dict || !PyDict_Check(dict.ptr())) {
+        return {};
+    }
+
+    return PyDict_GetItemString(dict.ptr(), key);
+}
+
+inline const json::Value *dict_item(const json::Value *dict, const char *key) {
+    if (!dict || dict->type != json::Value::Type::Object) {
+        return nullptr;
+    }
+
+    const auto it = std::find_if(dict->members.begin(), dict->members.end(), [key](const auto &member) {
+        return member.first == key;
+    });
+    return it != dict->members.end() ? &it->second : nullptr;
+}
+
+inline bool is_null(py::handle item) {
+    return !item || item.is_none();
+}
+
+inline bool is_null(const json::Value *item) {
+    return !item || item->type == json::Value::Type::Null;
+}
+
+inline size_t list_size(py::handle list) {
+    if (!PyList_Check(list.ptr())) {
+        throw py::type_error("Expected a list, got " + std::string(Py_TYPE(list.ptr())->tp_name));
+    }
+
+    return PyList_GET_SIZE(list.ptr());
+}
+
+inline size_t list_size(const json::Value *list) {
+    if (list->type != json::Value::Type::Array) {
+        throw py::type_error("Expected a list");
+    }
+
+    return list->array.size();
+}
+
+inline py::handle list_item(py::handle list, size_t i) {
+    return PyList_GET_ITEM(list.ptr(), Py_ssize_t(i));
+}
+
+inline const json::Value *list_item(const json::Value *list, size_t i) {
+    return &list->array[i];
+}
+
+template <typename T>
+T convert(py::handle item) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        // Copy the UTF-8 representation cached by Python, instead of going through pybind11's type caster
+        if (PyUnicode_Check(item.ptr())) {
+            Py_ssize_t size = 0;
+            if (const char *data = PyUnicode_AsUTF8AndSize(item.ptr(), &size)) {
+                return std::string(data, size);
+            }
+            throw py::error_already_set();
+        }
+    }
+
+    return item.cast<T>();
+}
+
 template <typename T>
-std::optional<T> optional_key(py::handle obj, const char *name) {
-    if (!obj.cast<py::dict>().contains(name)) {
+T convert(const json::Value *item) {
+    using Type = json::Value::Type;
+
+    if constexpr (std::is_same_v<T, std::string>) {
+        if (item->type == Type::String) {
+            return item->string;
+        }
+    } else if constexpr (std::is_same_v<T, bool>) {
+        if (item->type == Type::Bool) {
+            return item->boolean;
+        }
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        if (item->type == Type::Number) {
+            return T(item->number);
+        }
+    } else {
+        static_assert(!sizeof(T), "Unsupported type");
+    }
+
+    throw py::type_error("Unexpected type of JSON value");
+}
+
+template <typename T, typename Node>
+T required_key(Node obj, const char *name) {
+    const auto item = dict_item(obj, name);
+    if (!item) {
+        throw py::key_error(name);
+    }
+
+    return convert<T>(item);
+}
+
+template <typename T, typename Node>
+std::optional<T> optional_key(Node obj, const char *name) {
+    const auto item = dict_item(obj, name);
+    if (is_null(item)) {
         return std::nullopt;
     }
 
-    return obj[name].cast<std::optional<T>>();
+    return convert<T>(item);
 }
 
-meta::Thumbnail extract_thumbnail(py::handle thumbnail) {
+template <typename Node>
+meta::Thumbnail extract_thumbnail(Node thumbnail) {
     return {
-        thumbnail["url"].cast<std::string>(),
-        thumbnail["width"].cast<int>(),
-        thumbnail["height"].cast<int>()
+        required_key<std::string>(thumbnail, "url"),
+        required_key<int>(thumbnail, "width"),
+        required_key<int>(thumbnail, "height")
     };
 }
 
-meta::Artist extract_meta_artist(py::handle artist) {
+template <typename Node>
+meta::Artist extract_meta_artist(Node artist) {
     return {
-        artist["name"].cast<std::string>(),
-        artist["id"].cast<std::optional<std::string>>()
+        required_key<std::string>(artist, "name"),
+        optional_key<std::string>(artist, "id")
     };
 };
 
-playlist::Track extract_playlist_track(py::handle track);
-watch::Playlist::Track extract_watch_track(py::handle track);
-album::Track extract_album_track(py::handle track);
-video_info::Format extract_format(py::handle format);
-
-template <typename T>
-inline auto extract_py_list(py::handle obj) {
-    if (obj.is_none()) {
-        return std::vector<T>();
+template <typename Node>
+playlist::Track extract_playlist_track(Node track);
+template <typename Node>
+watch::Playlist::Track extract_watch_track(Node track);
+template <typename Node>
+album::Track extract_album_track(Node track);
+template <typename Node>
+video_info::Format extract_format(Node format);
+
+template <typename T, typename Node>
+inline auto extract_list(Node obj) {
+    std::vector<T> output;
+    if (is_null(obj)) {
+        return output;
     }
 
-    const auto list = obj.cast<py::list>();
-    std::vector<T> output;
+    const size_t size = list_size(obj);
+    output.reserve(size);
 
-    std::transform(list.begin(), list.end(), std::back_inserter(output), [](py::handle item) {
+    for (size_t i = 0; i < size; i++) {
+        const auto item = list_item(obj, i);
         if constexpr(std::is_same_v<T, meta::Thumbnail>) {
-            return extract_thumbnail(item);
+            output.push_back(extract_thumbnail(item));
         } else if constexpr(std::is_same_v<T, meta::Artist>) {
-            return extract_meta_artist(item);
+            output.push_back(extract_meta_artist(item));
         } else if constexpr(std::is_same_v<T, album::Track>) {
-            return extract_album_track(item);
+            output.push_back(extract_album_track(item));
         } else if constexpr(std::is_same_v<T, playlist::Track>) {
-            return extract_playlist_track(item);
+            output.push_back(extract_playlist_track(item));
         } else if constexpr(std::is_same_v<T, video_info::Format>) {
-            return extract_format(item);
+            output.push_back(extract_format(item));
         } else if constexpr(std::is_same_v<T, watch::Playlist::Track>) {
-            return extract_watch_track(item);
+            output.push_back(extract_watch_track(item));
         } else {
-            return item.cast<T>();
+            output.push_back(convert<T>(item));
         }
-    });
+    }
 
     return output;
 }
 
-album::Track extract_album_track(py::handle track) {
+template <typename Node>
+album::Track extract_album_track(Node track) {
     return {
         optional_key<bool>(track, "isExplicit"),
-        track["title"].cast<std::string>(),
-        extract_py_list<meta::Artist>(track["artists"]),
-        track["album"].cast<std::optional<std::string>>(),
-        track["videoId"].cast<std::optional<std::string>>(),  // E rated songs don't have a videoId
-        track["duration"].cast<std::optional<std::string>>(), //
-        track["likeStatus"].cast<std::optional<std::string>>()
+        required_key<std::string>(track, "title"),
+        extract_list<meta::Artist>(dict_item(track, "artists")),
+        optional_key<std::string>(track, "album"),
+        optional_key<std::string>(track, "videoId"),  // E rated songs don't have a videoId
+        optional_key<std::string>(track, "duration"), //
+        optional_key<std::string>(track, "likeStatus")
     };
 }
 
-video_info::Format extract_format(py::handle format) {
+template <typename Node>
+video_info::Format extract_format(Node format) {
     return {
         optional_key<float>(format, "quality"),
-        format["url"].cast<std::string>(),
-        format["vcodec"].cast<std::string>(),
+        required_key<std::string>(format, "url"),
+        required_key<std::string>(format, "vcodec"),
         optional_key<std::string>(format, "acodec").value_or("none") // returned inconsistently by yt-dlp
     };
 }
 
-meta::Album extract_meta_album(py::handle album) {
+template <typename Node>
+meta::Album extract_meta_album(Node album) {
     return meta::Album {
-        album["name"].cast<std::string>(),
-        album["id"].cast<std::optional<std::string>>()
+        required_key<std::string>(album, "name"),
+        optional_key<std::string>(album, "id")
     };
 }
 
-watch::Playlist::Track extract_watch_track(py::handle track) {
-    return {
-        track["title"].cast<std::string>(),
-        track["length"].cast<std::optional<std::string>>(),
-        track["videoId"].cast<std::string>(),
-        optional_key<std::string>(track, "playlistId"),
-        extract_py_list<meta::Thumbnail>(track["thumbnail"]),
-        track["likeStatus"].cast<std::optional<std::string>>(),
-        extract_py_list<meta::Artist>(track["artists"]),
-        [&]() -> std::optional<meta::Album> {
-            if (!track.cast<py::dict>().contains("album")) {
-                return std::nullopt;
-            }
+template <typename Node>
+std::optional<meta::Album> extract_optional_meta_album(Node album) {
+    if (is_null(album)) {
+        return std::nullopt;
+    }
 
-            if (track["album"].is_none()) {
-                return std::nullopt;
-            }
+    return extract_meta_album(album);
+}
 
-            return extract_meta_album(track["album"]);
-        }()
+template <typename Node>
+watch::Playlist::Track extract_watch_track(Node track) {
+    return {
+        required_key<std::string>(track, "title"),
+        optional_key<std::string>(track, "length"),
+        required_key<std::string>(track, "videoId"),
+        optional_key<std::string>(track, "playlistId"),
+        extract_list<meta::Thumbnail>(dict_item(track, "thumbnail")),
+        optional_key<std::string>(track, "likeStatus"),
+        extract_list<meta::Artist>(dict_item(track, "artists")),
+        extract_optional_meta_album(dict_item(track, "album"))
     };
 }
 
 
-playlist::Track extract_playlist_track(py::handle track) {
+template <typename Node>
+playlist::Track extract_playlist_track(Node track) {
     return {
-        track["videoId"].cast<std::optional<std::string>>(),
-        track["title"].cast<std::string>(),
-        extract_py_list<meta::Artist>(track["artists"]),
-        [&]() -> std::optional<meta::Album> {
-            if (track["album"].is_none()) {
-                return std::nullopt;
-            }
-
-            return extract_meta_album(track["album"]);
-        }(),
+        optional_key<std::string>(track, "videoId"),
+        required_key<std::string>(track, "title"),
+        extract_list<meta::Artist>(dict_item(track, "artists")),
+        extract_optional_meta_album(dict_item(track, "album")),
         optional_key<std::string>(track, "duration"),
-        track["likeStatus"].cast<std::optional<std::string>>(),
-        extract_py_list<meta::Thumbnail>(track["thumbnails"]),
-        track["isAvailable"].cast<bool>(),
+        optional_key<std::string>(track, "likeStatus"),
+        extract_list<meta::Thumbnail>(dict_item(track, "thumbnails")),
+        required_key<bool>(track, "isAvailable"),
         optional_key<bool>(track, "isExplicit")
     };
 }
 
-artist::Artist::Song::Album extract_song_album(py::handle album) {
+template <typename Node>
+artist::Artist::Song::Album extract_song_album(Node album) {
     return {
-        album["name"].cast<std::string>(),
-        album["id"].cast<std::string>()
+        required_key<std::string>(album, "name"),
+        required_key<std::string>(album, "id")
     };
 };
 
-template <typename T>
-auto extract_artist_section_results(py::handle section) {
-    if (!section.cast<py::dict>().contains("results")) {
-        return std::vector<T>();
+template <typename T, typename Node>
+auto extract_artist_section_results(Node section) {
+    std::vector<T> results;
+    const auto py_results = dict_item(section, "results");
+    if (is_null(py_results)) {
+        return results;
     }
 
-    const py::list py_results = section["results"];
-    std::vector<T> results;
-    std::transform(py_results.begin(), py_results.end(), std::back_inserter(results), [](py::handle result) {
+    const size_t size = list_size(py_results);
+    results.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        const auto result = list_item(py_results, i);
         if constexpr(std::is_same_v<T, artist::Artist::Song>) {
-            return artist::Artist::Song {
-                result["videoId"].cast<std::string>(),
-                result["title"].cast<std::string>(),
-                extract_py_list<meta::Thumbnail>(result["thumbnails"]),
-                extract_py_list<meta::Artist>(result["artists"]),
-                extract_song_album(result["album"])
-            };
+            results.push_back(artist::Artist::Song {
+                required_key<std::string>(result, "videoId"),
+                required_key<std::string>(result, "title"),
+                extract_list<meta::Thumbnail>(dict_item(result, "thumbnails")),
+                extract_list<meta::Artist>(dict_item(result, "artists")),
+                extract_song_album(dict_item(result, "album"))
+            });
         } else if constexpr(std::is_same_v<T, artist::Artist::Album>) {
-            return artist::Artist::Album {
-                result["title"].cast<std::string>(),
-                extract_py_list<meta::Thumbnail>(result["thumbnails"]),
-                result["year"].cast<std::optional<std::string>>(),
-                result["browseId"].cast<std::string>(),
+            results.push_back(artist::Artist::Album {
+                required_key<std::string>(result, "title"),
+                extract_list<meta::Thumbnail>(dict_item(result, "thumbnails")),
+                optional_key<std::string>(result, "year"),
+                required_key<std::string>(result, "browseId"),
                 std::nullopt
-            };
+            });
         } else if constexpr(std::is_same_v<T, artist::Artist::Single>) {
-            return artist::Artist::Single {
-                result["title"].cast<std::string>(),
-                extract_py_list<meta::Thumbnail>(result["thumbnails"]),
-                result["year"].cast<std::string>(),
-                result["browseId"].cast<std::string>()
-            };
+            results.push_back(artist::Artist::Single {
+                required_key<std::string>(result, "title"),
+                extract_list<meta::Thumbnail>(dict_item(result, "thumbnails")),
+                required_key<std::string>(result, "year"),
+                required_key<std::string>(result, "browseId")
+            });
         } else if constexpr(std::is_same_v<T, artist::Artist::Video>) {
-            return artist::Artist::Video {
-                result["title"].cast<std::string>(),
-                extract_py_list<meta::Thumbnail>(result["thumbnails"]),
+            results.push_back(artist::Artist::Video {
+                required_key<std::string>(result, "title"),
+                extract_list<meta::Thumbnail>(dict_item(result, "thumbnails")),
                 optional_key<std::string>(result, "views"),
-                result["videoId"].cast<std::string>(),
-                result["playlistId"].cast<std::string>()
-            };
+                required_key<std::string>(result, "videoId"),
+                required_key<std::string>(result, "playlistId")
+            });
         } else {
             Py_UNREACHABLE();
         }
-    });
+    }
 
     return results;
 }
 
-template<typename T>
-std::optional<artist::Artist::Section<T>> extract_artist_section(py::handle artist, const char* name) {
-    if (artist.cast<py::dict>().contains(name)) {
-        const auto section = artist[name];
+template<typename T, typename Node>
+std::optional<artist::Artist::Section<T>> extract_artist_section(Node artist, const char* name) {
+    if (const auto section = dict_item(artist, name)) {
         return artist::Artist::Section<T> {
-            section["browseId"].cast<std::optional<std::string>>(),
+            optional_key<std::string>(section, "browseId"),
             extract_artist_section_results<T>(section),
             optional_key<std::string>(section, "params")
         };
@@ -273,77 +753,130 @@ std::optional<artist::Artist::Section<T>> extract_artist_section(py::handle arti
     }
 }
 
-std::optional<search::SearchResultItem> extract_search_result(py::handle result) {
-    const auto resultType = result["resultType"].cast<std::string>();
+template <typename Node>
+std::optional<search::SearchResultItem> extract_search_result(Node result) {
+    const auto resultType = required_key<std::string>(result, "resultType");
 
-    if (result["category"].cast<std::optional<std::string>>() == "Top result") {
+    if (optional_key<std::string>(result, "category") == "Top result") {
         return search::TopResult {
-            result["category"].cast<std::string>(),
-            result["resultType"].cast<std::string>(),
+            required_key<std::string>(result, "category"),
+            required_key<std::string>(result, "resultType"),
             optional_key<std::string>(result, "videoId"),
             optional_key<std::string>(result, "title"),
-            extract_py_list<meta::Artist>(result["artists"]),
-            extract_py_list<meta::Thumbnail>(result["thumbnails"])
+            extract_list<meta::Artist>(dict_item(result, "artists")),
+            extract_list<meta::Thumbnail>(dict_item(result, "thumbnails"))
         };
     }
 
     if (resultType == "video") {
         return search::Video {
             {
-                result["videoId"].cast<std::string>(),
-                result["title"].cast<std::string>(),
-                extract_py_list<meta::Artist>(result["artists"]),
+                required_key<std::string>(result, "videoId"),
+                required_key<std::string>(result, "title"),
+                extract_list<meta::Artist>(dict_item(result, "artists")),
                 optional_key<std::string>(result, "duration"),
-                extract_py_list<meta::Thumbnail>(result["thumbnails"])
+                extract_list<meta::Thumbnail>(dict_item(result, "thumbnails"))
             },
             optional_key<std::string>(result, "views")
         };
     } else if (resultType == "song") {
         return search::Song {
             {
-                result["videoId"].cast<std::string>(),
-                result["title"].cast<std::string>(),
-                extract_py_list<meta::Artist>(result["artists"]),
+                required_key<std::string>(result, "videoId"),
+                required_key<std::string>(result, "title"),
+                extract_list<meta::Artist>(dict_item(result, "artists")),
                 optional_key<std::string>(result, "duration"),
-                extract_py_list<meta::Thumbnail>(result["thumbnails"])
+                extract_list<meta::Thumbnail>(dict_item(result, "thumbnails"))
             },
-            result["album"].is_none() ? std::optional<meta::Album> {} : extract_meta_album(result["album"]),
+            extract_optional_meta_album(dict_item(result, "album")),
             optional_key<bool>(result, "isExplicit")
         };
     } else if (resultType == "album") {
         return search::Album {
-            result["browseId"].cast<std::optional<std::string>>(),
-            result["title"].cast<std::string>(),
-            result["type"].cast<std::string>(),
-            extract_py_list<meta::Artist>(result["artists"]),
-            result["year"].cast<std::optional<std::string>>(),
-            result["isExplicit"].cast<bool>(),
-            extract_py_list<meta::Thumbnail>(result["thumbnails"])
+            optional_key<std::string>(result, "browseId"),
+            required_key<std::string>(result, "title"),
+            required_key<std::string>(result, "type"),
+            extract_list<meta::Artist>(dict_item(result, "artists")),
+            optional_key<std::string>(result, "year"),
+            required_key<bool>(result, "isExplicit"),
+            extract_list<meta::Thumbnail>(dict_item(result, "thumbnails"))
         };
     } else if (resultType == "playlist") {
         return search::Playlist {
-            result["browseId"].cast<std::string>(),
-            result["title"].cast<std::string>(),
-            result["author"].cast<std::optional<std::string>>(),
-            result["itemCount"].cast<std::string>(),
-            extract_py_list<meta::Thumbnail>(result["thumbnails"])
+            required_key<std::string>(result, "browseId"),
+            required_key<std::string>(result, "title"),
+            optional_key<std::string>(result, "author"),
+            required_key<std::string>(result, "itemCount"),
+            extract_list<meta::Thumbnail>(dict_item(result, "thumbnails"))
         };
     } else if (resultType == "artist") {
         return search::Artist {
-            result["browseId"].cast<std::string>(),
-            result["artist"].cast<std::string>(),
+            required_key<std::string>(result, "browseId"),
+            required_key<std::string>(result, "artist"),
             optional_key<std::string>(result, "shuffleId"),
             optional_key<std::string>(result, "radioId"),
-            extract_py_list<meta::Thumbnail>(result["thumbnails"])
+            extract_list<meta::Thumbnail>(dict_item(result, "thumbnails"))
         };
     } else {
         std::cerr << "Warning: Unsupported search result type found" << std::endl;
         std::cerr << "It's called: " << resultType << std::endl;
-        pyPrintPretty(result);
+        if constexpr (std::is_same_v<Node, py::handle>) {
+            pyPrintPretty(result);
+        }
         return std::nullopt;
     }
 }
 
+template <typename Node>
+playlist::Playlist extract_playlist(Node playlist) {
+    return {
+        required_key<std::string>(playlist, "id"),
+        required_key<std::string>(playlist, "privacy"),
+        required_key<std::string>(playlist, "title"),
+        extract_list<meta::Thumbnail>(dict_item(playlist, "thumbnails")),
+        extract_meta_artist(dict_item(playlist, "author")),
+        optional_key<std::string>(playlist, "year"),
+        required_key<std::string>(playlist, "duration"),
+        required_key<int>(playlist, "trackCount"),
+        extract_list<playlist::Track>(dict_item(playlist, "tracks")),
+    };
+}
+
+///
+/// Converts a result by serializing it with Python's json module in one call, and then parsing and extracting it
+/// without holding the GIL. Compared to walking the Python objects, this keeps the GIL for a much shorter time,
+/// so the other worker threads can run their Python calls meanwhile.
+///
+/// Only works for results made of dicts, lists and scalars, which the results of ytmusicapi are,
+/// including its post-processing. yt-dlp's results can contain other objects, so they are converted by walking them.
+///
+template <typename F>
+auto extract_json(py::handle obj, F &&extract) {
+    const std::string text = conversion::to_json(obj);
+
+    py::gil_scoped_release release;
+    const auto document = json::parse(text);
+    return extract(&document);
+}
+
+namespace conversion {
+
+std::string to_json(py::handle result) {
+    const auto text = py::module::import("json").attr("dumps")(result, "ensure_ascii"_a = false, "separators"_a = py::make_tuple(",", ":"));
+    return convert<std::string>(text);
+}
+
+playlist::Playlist playlist_from_objects(py::handle playlist) {
+    return extract_playlist(playlist);
+}
+
+playlist::Playlist playlist_from_json(std::string_view text) {
+    const auto document = json::parse(text);
+    return extract_playlist(&document);
+}
+
+}
+
 YTMusic::YTMusic(
         const std::optional<std::string> &auth,
         const std::optional<std::string> &user,
@@ -368,123 +901,171 @@ std::vector<search::SearchResultItem> YTMusic::search(
         const int limit,
         const bool ignore_spelling) const
 {
-    const auto results = d->get_ytmusic().attr("search")("query"_a=query, "filter"_a=filter, "scope"_a=scope, "limit"_a = limit, "ignore_spelling"_a = ignore_spelling).cast<py::list>();
-
-    std::vector<search::SearchResultItem> output;
-    for (const auto &result : results) {
-        if (result.is_none()) {
-            continue;
-        }
+    CallScope scope(*d);
+
+    const auto results = d->get_ytmusic().attr("search")("query"_a=query, "filter"_a=filter, "scope"_a=scope, "limit"_a = limit, "ignore_spelling"_a = ignore_spelling);
+
+    return extract_json(results, [](const json::Value *results) {
+        std::vector<search::SearchResultItem> output;
+        const size_t size = list_size(results);
+        output.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            const auto result = list_item(results, i);
+            if (is_null(result)) {
+                continue;
+            }
 
-        try {
-            if (const auto opt = extract_search_result(result); opt.has_value()) {
-                output.push_back(opt.value());
+            try {
+                if (auto opt = extract_search_result(result); opt.has_value()) {
+                    output.push_back(std::move(*opt));
+                }
+            } catch (const std::exception &e) {
+                std::cerr << "Failed to parse search result because:" << e.what();
             }
-        } catch (const std::exception &e) {
-            std::cerr << "Failed to parse search result because:" << e.what();
         }
-    };
 
-    return output;
+        return output;
+    });
 }
 
 artist::Artist YTMusic::get_artist(const std::string &channel_id) const
 {
-    const auto artist = d->get_ytmusic().attr("get_artist")(channel_id);
-    return artist::Artist {
-        optional_key<std::string>(artist, "description"),
-        artist["views"].cast<std::optional<std::string>>(),
-        artist["name"].cast<std::string>(),
-        artist["channelId"].cast<std::string>(),
-        artist["subscribers"].cast<std::optional<std::string>>(),
-        artist["subscribed"].cast<bool>(),
-        extract_py_list<meta::Thumbnail>(artist["thumbnails"]),
-        extract_artist_section<artist::Artist::Song>(artist, "songs"),
-        extract_artist_section<artist::Artist::Album>(artist, "albums"),
-        extract_artist_section<artist::Artist::Single>(artist, "singles"),
-        extract_artist_section<artist::Artist::Video>(artist, "videos"),
-    };
+    CallScope scope(*d);
+
+    return extract_json(d->get_ytmusic().attr("get_artist")(channel_id), [](const json::Value *artist) {
+        return artist::Artist {
+            optional_key<std::string>(artist, "description"),
+            optional_key<std::string>(artist, "views"),
+            required_key<std::string>(artist, "name"),
+            required_key<std::string>(artist, "channelId"),
+            optional_key<std::string>(artist, "subscribers"),
+            required_key<bool>(artist, "subscribed"),
+            extract_list<meta::Thumbnail>(dict_item(artist, "thumbnails")),
+            extract_artist_section<artist::Artist::Song>(artist, "songs"),
+            extract_artist_section<artist::Artist::Album>(artist, "albums"),
+            extract_artist_section<artist::Artist::Single>(artist, "singles"),
+            extract_artist_section<artist::Artist::Video>(artist, "videos"),
+        };
+    });
 }
 
 album::Album YTMusic::get_album(const std::string &browseId) const
 {
-    const auto album = d->get_ytmusic().attr("get_album")(browseId);
-    return {
-        album["title"].cast<std::string>(),
-        album["trackCount"].cast<int>(),
-        album["duration"].cast<std::string>(),
-        album["audioPlaylistId"].cast<std::string>(),
-        optional_key<std::string>(album, "year"),
-        optional_key<std::string>(album, "description"),
-        extract_py_list<meta::Thumbnail>(album["thumbnails"]),
-        extract_py_list<album::Track>(album["tracks"]),
-        extract_py_list<meta::Artist>(album["artists"])
-    };
+    CallScope scope(*d);
+
+    return extract_json(d->get_ytmusic().attr("get_album")(browseId), [](const json::Value *album) {
+        return album::Album {
+            required_key<std::string>(album, "title"),
+            required_key<int>(album, "trackCount"),
+            required_key<std::string>(album, "duration"),
+            required_key<std::string>(album, "audioPlaylistId"),
+            optional_key<std::string>(album, "year"),
+            optional_key<std::string>(album, "description"),
+            extract_list<meta::Thumbnail>(dict_item(album, "thumbnails")),
+            extract_list<album::Track>(dict_item(album, "tracks")),
+            extract_list<meta::Artist>(dict_item(album, "artists"))
+        };
+    });
 }
 
 std::optional<song::Song> YTMusic::get_song(const std::string &video_id) const
 {
+    CallScope scope(*d);
+
     const auto song = d->get_ytmusic().attr("get_song")(video_id);
-    auto videoDetails = song["videoDetails"].cast<py::dict>();
+    const auto videoDetails = dict_item(song, "videoDetails");
 
-    if (!videoDetails.contains("videoId")) {
+    if (!dict_item(videoDetails, "videoId")) {
         return std::nullopt;
     }
 
     return song::Song {
-        videoDetails["videoId"].cast<std::string>(),
-        videoDetails["title"].cast<std::string>(),
-        videoDetails["lengthSeconds"].cast<std::string>(),
-        videoDetails["channelId"].cast<std::string>(),
-        videoDetails["isOwnerViewing"].cast<bool>(),
-        videoDetails["isCrawlable"].cast<bool>(),
+        required_key<std::string>(videoDetails, "videoId"),
+        required_key<std::string>(videoDetails, "title"),
+        required_key<std::string>(videoDetails, "lengthSeconds"),
+        required_key<std::string>(videoDetails, "channelId"),
+        required_key<bool>(videoDetails, "isOwnerViewing"),
+        required_key<bool>(videoDetails, "isCrawlable"),
         song::Song::Thumbnail {
-            extract_py_list<meta::Thumbnail>(videoDetails["thumbnail"]["thumbnails"])
+            extract_list<meta::Thumbnail>(dict_item(dict_item(videoDetails, "thumbnail"), "thumbnails"))
         },
-        videoDetails["viewCount"].cast<std::string>(),
-        videoDetails["author"].cast<std::string>(),
-        videoDetails["isPrivate"].cast<bool>(),
-        videoDetails["isUnpluggedCorpus"].cast<bool>(),
-        videoDetails["isLiveContent"].cast<bool>(),
-        [&]() -> std::vector<std::string> {
-            if (videoDetails.contains("artists")) {
-                return extract_py_list<std::string>(videoDetails["artists"]);
-            } else {
-                return {};
-            }
-        }(),
+        required_key<std::string>(videoDetails, "viewCount"),
+        required_key<std::string>(videoDetails, "author"),
+        required_key<bool>(videoDetails, "isPrivate"),
+        required_key<bool>(videoDetails, "isUnpluggedCorpus"),
+        required_key<bool>(videoDetails, "isLiveContent"),
+        extract_list<std::string>(dict_item(videoDetails, "artists")),
     };
 }
 
 playlist::Playlist YTMusic::get_playlist(const std::string &playlist_id, int limit) const
 {
-    const auto playlist = d->get_ytmusic().attr("get_playlist")(playlist_id, limit);
+    CallScope scope(*d);
 
-    return {
-        playlist["id"].cast<std::string>(),
-        playlist["privacy"].cast<std::string>(),
-        playlist["title"].cast<std::string>(),
-        extract_py_list<meta::Thumbnail>(playlist["thumbnails"]),
-        extract_meta_artist(playlist["author"]),
-        optional_key<std::string>(playlist, "year"),
-        playlist["duration"].cast<std::string>(),
-        playlist["trackCount"].cast<int>(),
-        extract_py_list<playlist::Track>(playlist["tracks"]),
-    };
+    return extract_json(d->get_ytmusic().attr("get_playlist")(playlist_id, limit), [](const json::Value *playlist) {
+        return extract_playlist(playlist);
+    });
+}
+
+void YTMusic::get_playlist_pages(const std::string &playlist_id,
+                                 const std::function<void(playlist::Playlist &&)> &on_page,
+                                 int limit,
+                                 int page_size) const
+{
+    CallScope scope(*d);
+
+    // ytmusicapi can't continue a previous request, so the remaining tracks are fetched
+    // with a second request. Its first page is answered from the first request, so it isn't downloaded twice.
+    ReplayedFirstResponse replayed(d->get_ytmusic());
+
+    auto first_page = extract_json(d->get_ytmusic().attr("get_playlist")(playlist_id, std::min(page_size, limit)), [](const json::Value *playlist) {
+        return extract_playlist(playlist);
+    });
+    const auto first_page_size = first_page.tracks.size();
+    const bool complete = first_page_size < size_t(page_size)
+        || first_page_size >= size_t(std::min(first_page.track_count, limit));
+
+    {
+        py::gil_scoped_release release;
+        on_page(std::move(first_page));
+    }
+
+    if (complete) {
+        return;
+    }
+
+    const auto result = d->get_ytmusic().attr("get_playlist")(playlist_id, limit);
+    const auto py_tracks = dict_item(result, "tracks");
+    if (is_null(py_tracks)) {
+        return;
+    }
+
+    extract_json(py_tracks, [&](const json::Value *tracks) {
+        const size_t size = list_size(tracks);
+        playlist::Playlist page {};
+        page.tracks.reserve(size - std::min(first_page_size, size));
+        for (size_t i = first_page_size; i < size; i++) {
+            page.tracks.push_back(extract_playlist_track(list_item(tracks, i)));
+        }
+
+        on_page(std::move(page));
+    });
 }
 
 std::vector<artist::Artist::Album> YTMusic::get_artist_albums(const std::string &channel_id, const std::string &params) const
 {
+    CallScope scope(*d);
+
     const auto py_albums = d->get_ytmusic().attr("get_artist_albums")(channel_id, params);
     std::vector<artist::Artist::Album> albums;
 
     std::transform(py_albums.begin(), py_albums.end(), std::back_inserter(albums), [](py::handle album) {
         return artist::Artist::Album {
-            album["title"].cast<std::string>(),
-            extract_py_list<meta::Thumbnail>(album["thumbnails"]),
-            album["year"].cast<std::string>(),
-            album["browseId"].cast<std::string>(),
-            album["type"].cast<std::string>()
+            required_key<std::string>(album, "title"),
+            extract_list<meta::Thumbnail>(dict_item(album, "thumbnails")),
+            required_key<std::string>(album, "year"),
+            required_key<std::string>(album, "browseId"),
+            required_key<std::string>(album, "type")
         };
     });
 
@@ -493,17 +1074,19 @@ std::vector<artist::Artist::Album> YTMusic::get_artist_albums(const std::string
 
 video_info::VideoInfo YTMusic::extract_video_info(const std::string &video_id) const
 {
+    CallScope scope(*d);
+
     using namespace pybind11::literals;
 
     const auto info = d->get_ytdl().attr("extract_info")(video_id, "download"_a=py::bool_(false));
     
     return {
-        info["id"].cast<std::string>(),
-        info["title"].cast<std::string>(),
-        info.contains("artist") ? info["artist"].cast<std::string>() : "",
-        info.contains("channel") ? info["channel"].cast<std::string>() : "",
-        extract_py_list<video_info::Format>(info["formats"]),
-        info["thumbnail"].cast<std::string>()
+        required_key<std::string>(info, "id"),
+        required_key<std::string>(info, "title"),
+        optional_key<std::string>(info, "artist").value_or(""),
+        optional_key<std::string>(info, "channel").value_or(""),
+        extract_list<video_info::Format>(dict_item(info, "formats")),
+        required_key<std::string>(info, "thumbnail")
     };
 }
 
@@ -511,29 +1094,55 @@ watch::Playlist YTMusic::get_watch_playlist(const std::optional<std::string> &vi
                                             const std::optional<std::string> &playlistId,
                                             int limit) const
 {
+    CallScope scope(*d);
+
     const auto playlist = d->get_ytmusic().attr("get_watch_playlist")("videoId"_a = videoId,
                                                                 "playlistId"_a = playlistId,
                                                                 "limit"_a = py::int_(limit));
 
-    return {
-        extract_py_list<watch::Playlist::Track>(playlist["tracks"]),
-        playlist["lyrics"].cast<std::optional<std::string>>()
-    };
+    return extract_json(playlist, [](const json::Value *playlist) {
+        return watch::Playlist {
+            extract_list<watch::Playlist::Track>(dict_item(playlist, "tracks")),
+            optional_key<std::string>(playlist, "lyrics")
+        };
+    });
 }
 
 
 Lyrics YTMusic::get_lyrics(const std::string &browse_id) const
 {
+    CallScope scope(*d);
+
     auto lyrics = d->get_ytmusic().attr("get_lyrics")(browse_id);
 
     return {
-        lyrics["source"].cast<std::optional<std::string>>(),
-        lyrics["lyrics"].cast<std::string>()
+        optional_key<std::string>(lyrics, "source"),
+        required_key<std::string>(lyrics, "lyrics")
     };
 }
 
+void YTMusic::interrupt() const
+{
+    py::gil_scoped_acquire gil;
+
+    if (d->running_thread) {
+        PyThreadState_SetAsyncExc(d->running_thread, PyExc_KeyboardInterrupt);
+    } else {
+        d->interrupt_pending = true;
+    }
+}
+
+void YTMusic::reset_interruption() const
+{
+    py::gil_scoped_acquire gil;
+
+    d->interrupt_pending = false;
+}
+
 std::string YTMusic::get_version() const
 {
+    CallScope scope(*d);
+
     d->get_ytmusic();
     return d->ytmusicapi_module.attr("__version__").cast<std::string>();
 }
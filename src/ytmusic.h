@@ -7,6 +7,7 @@
 
 #include <string>
 #include <optional>
+#include <functional>
 #include <map>
 #include <variant>
 #include <vector>
@@ -25,14 +26,19 @@ struct Thumbnail {
     bool operator<(const Thumbnail &other) const {
         return height < other.height;
     }
+    bool operator==(const Thumbnail &other) const = default;
 };
 struct Artist {
     std::string name;
     std::optional<std::string> id;
+
+    bool operator==(const Artist &other) const = default;
 };
 struct Album {
     std::string name;
     std::optional<std::string> id;
+
+    bool operator==(const Album &other) const = default;
 };
 }
 
@@ -47,10 +53,14 @@ struct Media {
     std::vector<meta::Artist> artists;
     std::optional<std::string> duration;
     std::vector<meta::Thumbnail> thumbnails;
+
+    bool operator==(const Media &other) const = default;
 };
 
 struct Video : public Media {
     std::optional<std::string> views;
+
+    bool operator==(const Video &other) const = default;
 };
 
 struct Playlist {
@@ -59,11 +69,15 @@ struct Playlist {
     std::optional<std::string> author;
     std::string item_count;
     std::vector<meta::Thumbnail> thumbnails;
+
+    bool operator==(const Playlist &other) const = default;
 };
 
 struct Song : public Media {
     std::optional<meta::Album> album;
     std::optional<bool> is_explicit;
+
+    bool operator==(const Song &other) const = default;
 };
 
 struct Album {
@@ -74,6 +88,8 @@ struct Album {
     std::optional<std::string> year;
     bool is_explicit;
     std::vector<meta::Thumbnail> thumbnails;
+
+    bool operator==(const Album &other) const = default;
 };
 
 struct Artist {
@@ -82,6 +98,8 @@ struct Artist {
     std::optional<std::string> shuffle_id;
     std::optional<std::string> radio_id;
     std::vector<meta::Thumbnail> thumbnails;
+
+    bool operator==(const Artist &other) const = default;
 };
 
 struct TopResult {
@@ -91,6 +109,8 @@ struct TopResult {
     std::optional<std::string> title;
     std::vector<meta::Artist> artists;
     std::vector<meta::Thumbnail> thumbnails;
+
+    bool operator==(const TopResult &other) const = default;
 };
 
 using SearchResultItem = std::variant<Video, Playlist, Song, Album, Artist, TopResult>;
@@ -308,6 +328,15 @@ public:
     /// https://ytmusicapi.readthedocs.io/en/latest/reference.html#ytmusicapi.YTMusic.get_playlist
     playlist::Playlist get_playlist(const std::string &playlist_id, int limit = 1024) const;
 
+    /// Like get_playlist, but passes the playlist to on_page in pieces, so the first tracks can be shown
+    /// before the whole playlist is downloaded.
+    /// The first page contains the playlist metadata and its first page_size tracks,
+    /// the following pages only contain the tracks that were not part of a previous page.
+    void get_playlist_pages(const std::string &playlist_id,
+                            const std::function<void(playlist::Playlist &&page)> &on_page,
+                            int limit = 1024,
+                            int page_size = 100) const;
+
     /// https://ytmusicapi.readthedocs.io/en/latest/reference.html#ytmusicapi.YTMusic.get_artist_albums
     std::vector<artist::Artist::Album> get_artist_albums(const std::string &channel_id, const std::string &params) const;
 
@@ -323,6 +352,14 @@ public:
 
     std::string get_version() const;
 
+    /// Interrupts the call that is currently running on this object.
+    /// The interrupted call throws an exception once the Python code reaches its next safe point.
+    /// If no call is running, the next call throws as soon as it starts, until reset_interruption() is called.
+    /// Can be called from any thread.
+    void interrupt() const;
+    /// Drops an interruption that did not hit a call, so it doesn't affect later ones
+    void reset_interruption() const;
+
     // TODO wrap more methods
 
 private:
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2026 agent <agent@local>
+//
+// SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+
+#ifndef YTMUSICCONVERSION_H
+#define YTMUSICCONVERSION_H
+
+#include "ytmusic.h"
+
+#include <pybind11/pytypes.h>
+
+#include <string>
+#include <string_view>
+
+///
+/// The two ways YTMusic converts results into the structs of ytmusic.h.
+/// YTMusic picks one of them for each call, they are only exposed here to be compared in the benchmarks.
+///
+namespace conversion {
+
+/// Converts by looking up each field in the Python objects. Requires the GIL.
+playlist::Playlist playlist_from_objects(pybind11::handle playlist);
+
+/// Serializes a result using Python's json module. Requires the GIL.
+std::string to_json(pybind11::handle result);
+
+/// Converts a result serialized by to_json. Doesn't need the GIL.
+playlist::Playlist playlist_from_json(std::string_view json);
+
+}
+
+#endif // YTMUSICCONVERSION_H